@@ -0,0 +1,361 @@
+/*
+  ==============================================================================
+
+    MakoAudit.cpp
+    R1.01 Realtime safety audit hooks, violation ring and the report thread.
+
+  ==============================================================================
+*/
+
+#include "MakoAudit.h"
+
+#if MAKO_AUDIT
+
+#include <cstddef>
+
+#if defined(__GLIBC__)
+ #include <dlfcn.h>
+ #include <pthread.h>
+ #define MAKO_AUDIT_GLIBC 1
+#endif
+
+//R1.01 Our hooks run inside malloc, so thread locals must not allocate on first use (initial exec TLS).
+//R1.01 pthread_mutex_lock is made hidden so our replacement only binds inside the plugin.
+#if defined(__GNUC__)
+ #define MAKO_AUDIT_TLS __attribute__((tls_model("initial-exec")))
+ #define MAKO_AUDIT_LOCAL __attribute__((visibility("hidden")))
+#else
+ #define MAKO_AUDIT_TLS
+ #define MAKO_AUDIT_LOCAL
+#endif
+
+#if MAKO_AUDIT_GLIBC
+//R1.01 glibc: the C allocator and pthread mutexes, as called from inside the plugin
+//R1.01 (JUCE code compiled into us included). Passed on to the real glibc functions.
+//R1.01 These must come before any header that declares them, or the hidden attribute is ignored.
+//R1.01 malloc and friends are compiler builtins and can not be hidden, so like operator new they
+//R1.01 only bind inside a plugin if the audit build is linked with -Wl,-Bsymbolic-functions.
+extern "C" {
+    void* __libc_malloc(size_t Size);
+    void* __libc_calloc(size_t Count, size_t Size);
+    void* __libc_realloc(void* Ptr, size_t Size);
+    void __libc_free(void* Ptr);
+
+    static void* Real_MutexLock = nullptr;
+
+    void* malloc(size_t Size) noexcept
+    {
+        MakoAudit::Violation(MakoAudit::e_Alloc, "malloc");
+        return __libc_malloc(Size);
+    }
+
+    void* calloc(size_t Count, size_t Size) noexcept
+    {
+        MakoAudit::Violation(MakoAudit::e_Alloc, "calloc");
+        return __libc_calloc(Count, Size);
+    }
+
+    void* realloc(void* Ptr, size_t Size) noexcept
+    {
+        MakoAudit::Violation(MakoAudit::e_Alloc, "realloc");
+        return __libc_realloc(Ptr, Size);
+    }
+
+    void free(void* Ptr) noexcept
+    {
+        if (Ptr != nullptr) MakoAudit::Violation(MakoAudit::e_Free, "free");
+        __libc_free(Ptr);
+    }
+
+    MAKO_AUDIT_LOCAL int pthread_mutex_lock(pthread_mutex_t* Mutex) noexcept
+    {
+        MakoAudit::Violation(MakoAudit::e_Lock, "pthread_mutex_lock");
+
+        void* Real = __atomic_load_n(&Real_MutexLock, __ATOMIC_ACQUIRE);
+        if (Real == nullptr)
+        {
+            Real = dlsym(RTLD_NEXT, "pthread_mutex_lock");
+            __atomic_store_n(&Real_MutexLock, Real, __ATOMIC_RELEASE);
+        }
+        return reinterpret_cast<int (*)(pthread_mutex_t*)>(Real)(Mutex);
+    }
+}
+#endif
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <mutex>
+#include <new>
+#include <thread>
+
+#if MAKO_AUDIT_GLIBC
+ #include <execinfo.h>
+#elif defined(__APPLE__)
+ #include <execinfo.h>
+#elif defined(_WIN32)
+ #include <windows.h>
+ #include <malloc.h>
+#endif
+
+namespace MakoAudit
+{
+    //R1.01 One violation with the stack that caused it.
+    const int Ring_Size = 256;
+    const int Frame_Max = 24;
+
+    struct tp_violation {
+        std::atomic<bool> Ready{ false };
+        int Type;
+        const char* What;
+        const char* Where;
+        int Frames;
+        void* Frame[Frame_Max];
+    };
+
+    //R1.01 Many audio threads may write (one per instance in some hosts), the report thread reads.
+    static tp_violation Ring[Ring_Size];
+    static std::atomic<uint32_t> Ring_Claim{ 0 };
+    static std::atomic<uint32_t> Ring_Read{ 0 };
+    static std::atomic<int> Total{ 0 };
+    static std::atomic<int> Dropped{ 0 };
+
+    static thread_local int RT_Depth MAKO_AUDIT_TLS = 0;
+    static thread_local const char* RT_Where MAKO_AUDIT_TLS = nullptr;
+    static thread_local bool In_Hook MAKO_AUDIT_TLS = false;
+
+    //R1.01 Report thread state. Only touched by Start/Stop and the report thread itself.
+    static std::mutex Report_Lock;
+    static std::condition_variable Report_Wake;
+    static std::thread Report_Thread;
+    static int Report_Users = 0;
+    static bool Report_Quit = false;
+
+    static int Capture(void** Frame, int Max)
+    {
+#if defined(_WIN32)
+        return int(CaptureStackBackTrace(2, DWORD(Max), Frame, nullptr));
+#elif MAKO_AUDIT_GLIBC || defined(__APPLE__)
+        return backtrace(Frame, Max);
+#else
+        return 0;
+#endif
+    }
+
+    void Enter(const char* Where)
+    {
+        if (RT_Depth++ == 0) RT_Where = Where;
+    }
+
+    void Leave()
+    {
+        RT_Depth--;
+    }
+
+    int Count()
+    {
+        return Total.load();
+    }
+
+    void Violation(int Type, const char* What)
+    {
+        //R1.01 Not a realtime thread, or we are already in here (the stack capture may allocate).
+        if ((RT_Depth == 0) || In_Hook) return;
+        In_Hook = true;
+        Total++;
+
+        uint32_t Slot = Ring_Claim.load();
+        do
+        {
+            if (uint32_t(Ring_Size) <= Slot - Ring_Read.load(std::memory_order_acquire))
+            {
+                Dropped++;
+                In_Hook = false;
+                return;
+            }
+        } while (!Ring_Claim.compare_exchange_weak(Slot, Slot + 1));
+
+        tp_violation& V = Ring[Slot % Ring_Size];
+        V.Type = Type;
+        V.What = What;
+        V.Where = RT_Where;
+        V.Frames = Capture(V.Frame, Frame_Max);
+        V.Ready.store(true, std::memory_order_release);
+
+        In_Hook = false;
+    }
+
+    //R1.01 Write out every finished violation.
+    static void Report_Ring(FILE* File)
+    {
+        static const char* TypeName[e_Type_Count] = { "heap allocation", "heap free", "lock" };
+        uint32_t r = Ring_Read.load(std::memory_order_relaxed);
+
+        while (r != Ring_Claim.load(std::memory_order_acquire))
+        {
+            tp_violation& V = Ring[r % Ring_Size];
+            if (!V.Ready.load(std::memory_order_acquire)) break;
+
+            std::fprintf(File, "REALTIME VIOLATION: %s (%s) inside %s\n", TypeName[V.Type], V.What, V.Where);
+            std::fprintf(stderr, "MakoAudit: %s (%s) inside %s\n", TypeName[V.Type], V.What, V.Where);
+#if MAKO_AUDIT_GLIBC || defined(__APPLE__)
+            std::fflush(File);
+            backtrace_symbols_fd(V.Frame, V.Frames, fileno(File));
+#else
+            for (int f = 0; f < V.Frames; f++) std::fprintf(File, "    %p\n", V.Frame[f]);
+#endif
+            std::fprintf(File, "\n");
+
+            V.Ready.store(false, std::memory_order_relaxed);
+            r++;
+            Ring_Read.store(r, std::memory_order_release);
+        }
+        std::fflush(File);
+    }
+
+    static void Report_Run()
+    {
+        const char* Env = std::getenv("MAKO_AUDIT_FILE");
+        std::string Path = (Env != nullptr) ? std::string(Env) : (std::filesystem::temp_directory_path() / "MakoPrecog_audit.log").string();
+        FILE* File = std::fopen(Path.c_str(), "w");
+        if (File == nullptr) return;
+
+        std::unique_lock<std::mutex> Lock(Report_Lock);
+        while (!Report_Quit)
+        {
+            Report_Wake.wait_for(Lock, std::chrono::milliseconds(100));
+            Report_Ring(File);
+        }
+
+        Report_Ring(File);
+        std::fprintf(File, "%d violations, %d not stored (ring full).\n", Total.load(), Dropped.load());
+        std::fclose(File);
+    }
+
+    void Start()
+    {
+        //R1.01 The first stack capture loads the unwinder, which allocates. Get that done now.
+        void* Frame[2];
+        Capture(Frame, 2);
+
+        std::lock_guard<std::mutex> Lock(Report_Lock);
+        if (Report_Users++ == 0)
+        {
+            Report_Quit = false;
+            Report_Thread = std::thread(Report_Run);
+        }
+    }
+
+    void Stop()
+    {
+        std::thread Done;
+        {
+            std::lock_guard<std::mutex> Lock(Report_Lock);
+            if ((Report_Users == 0) || (--Report_Users != 0)) return;
+            Report_Quit = true;
+            Done = std::move(Report_Thread);
+        }
+        Report_Wake.notify_all();
+        if (Done.joinable()) Done.join();
+    }
+}
+
+//==============================================================================
+//R1.01 HOOKS
+//==============================================================================
+static void* Audit_Malloc(size_t Size)
+{
+#if MAKO_AUDIT_GLIBC
+    return __libc_malloc(Size ? Size : 1);
+#else
+    return std::malloc(Size ? Size : 1);
+#endif
+}
+
+static void Audit_Free(void* Ptr)
+{
+#if MAKO_AUDIT_GLIBC
+    __libc_free(Ptr);
+#else
+    std::free(Ptr);
+#endif
+}
+
+static void* Audit_Aligned(size_t Size, size_t Align)
+{
+#if defined(_WIN32)
+    return _aligned_malloc(Size ? Size : 1, Align);
+#else
+    void* Ptr = nullptr;
+    if (Align < sizeof(void*)) Align = sizeof(void*);
+    return (posix_memalign(&Ptr, Align, Size ? Size : 1) == 0) ? Ptr : nullptr;
+#endif
+}
+
+static void Audit_AlignedFree(void* Ptr)
+{
+#if defined(_WIN32)
+    _aligned_free(Ptr);
+#else
+    Audit_Free(Ptr);
+#endif
+}
+
+static void* Audit_New(size_t Size, const char* What)
+{
+    MakoAudit::Violation(MakoAudit::e_Alloc, What);
+    void* Ptr = Audit_Malloc(Size);
+    if (Ptr == nullptr) throw std::bad_alloc();
+    return Ptr;
+}
+
+static void* Audit_NewAligned(size_t Size, std::align_val_t Align, const char* What)
+{
+    MakoAudit::Violation(MakoAudit::e_Alloc, What);
+    void* Ptr = Audit_Aligned(Size, size_t(Align));
+    if (Ptr == nullptr) throw std::bad_alloc();
+    return Ptr;
+}
+
+static void Audit_Delete(void* Ptr, const char* What)
+{
+    if (Ptr == nullptr) return;
+    MakoAudit::Violation(MakoAudit::e_Free, What);
+    Audit_Free(Ptr);
+}
+
+static void Audit_DeleteAligned(void* Ptr, const char* What)
+{
+    if (Ptr == nullptr) return;
+    MakoAudit::Violation(MakoAudit::e_Free, What);
+    Audit_AlignedFree(Ptr);
+}
+
+//R1.01 Global operator new/delete, every flavour.
+void* operator new(size_t Size) { return Audit_New(Size, "operator new"); }
+void* operator new[](size_t Size) { return Audit_New(Size, "operator new[]"); }
+void* operator new(size_t Size, const std::nothrow_t&) noexcept { MakoAudit::Violation(MakoAudit::e_Alloc, "operator new"); return Audit_Malloc(Size); }
+void* operator new[](size_t Size, const std::nothrow_t&) noexcept { MakoAudit::Violation(MakoAudit::e_Alloc, "operator new[]"); return Audit_Malloc(Size); }
+void* operator new(size_t Size, std::align_val_t Align) { return Audit_NewAligned(Size, Align, "operator new"); }
+void* operator new[](size_t Size, std::align_val_t Align) { return Audit_NewAligned(Size, Align, "operator new[]"); }
+void* operator new(size_t Size, std::align_val_t Align, const std::nothrow_t&) noexcept { MakoAudit::Violation(MakoAudit::e_Alloc, "operator new"); return Audit_Aligned(Size, size_t(Align)); }
+void* operator new[](size_t Size, std::align_val_t Align, const std::nothrow_t&) noexcept { MakoAudit::Violation(MakoAudit::e_Alloc, "operator new[]"); return Audit_Aligned(Size, size_t(Align)); }
+
+void operator delete(void* Ptr) noexcept { Audit_Delete(Ptr, "operator delete"); }
+void operator delete[](void* Ptr) noexcept { Audit_Delete(Ptr, "operator delete[]"); }
+void operator delete(void* Ptr, size_t) noexcept { Audit_Delete(Ptr, "operator delete"); }
+void operator delete[](void* Ptr, size_t) noexcept { Audit_Delete(Ptr, "operator delete[]"); }
+void operator delete(void* Ptr, const std::nothrow_t&) noexcept { Audit_Delete(Ptr, "operator delete"); }
+void operator delete[](void* Ptr, const std::nothrow_t&) noexcept { Audit_Delete(Ptr, "operator delete[]"); }
+void operator delete(void* Ptr, std::align_val_t) noexcept { Audit_DeleteAligned(Ptr, "operator delete"); }
+void operator delete[](void* Ptr, std::align_val_t) noexcept { Audit_DeleteAligned(Ptr, "operator delete[]"); }
+void operator delete(void* Ptr, size_t, std::align_val_t) noexcept { Audit_DeleteAligned(Ptr, "operator delete"); }
+void operator delete[](void* Ptr, size_t, std::align_val_t) noexcept { Audit_DeleteAligned(Ptr, "operator delete[]"); }
+void operator delete(void* Ptr, std::align_val_t, const std::nothrow_t&) noexcept { Audit_DeleteAligned(Ptr, "operator delete"); }
+void operator delete[](void* Ptr, std::align_val_t, const std::nothrow_t&) noexcept { Audit_DeleteAligned(Ptr, "operator delete[]"); }
+
+
+#endif
@@ -0,0 +1,75 @@
+/*
+  ==============================================================================
+
+    MakoAudit.h
+    R1.01 Realtime safety AUDIT. Proves processBlock never allocates or locks.
+
+    Build with MAKO_AUDIT=1 (debug builds only) to turn it on. processBlock marks
+    its thread as realtime for as long as it runs. While a thread is marked:
+    * Global operator new/delete (all platforms) are reported.
+    * malloc/calloc/realloc/free and pthread_mutex_lock are reported (Linux, glibc).
+    * Our own lock sites call MAKO_AUDIT_LOCK, which covers Windows and macOS.
+
+    On Linux link the audit build with -Wl,-Bsymbolic-functions, otherwise the
+    host's operator new and malloc are used instead of ours.
+
+    Each violation is stored with a stack trace in a fixed ring (no allocation),
+    and a background thread writes them to MAKO_AUDIT_FILE if set, or
+    MakoPrecog_audit.log in the temp folder.
+
+    Set MAKO_AUDIT_STRESS=1 as well to have the plugin move every parameter at
+    random from a background thread, so every settings path gets exercised.
+
+    With MAKO_AUDIT off everything here compiles to nothing.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#ifndef MAKO_AUDIT
+ #define MAKO_AUDIT 0
+#endif
+
+#if MAKO_AUDIT
+
+namespace MakoAudit
+{
+    enum { e_Alloc, e_Free, e_Lock, e_Type_Count };
+
+    //R1.01 Mark the calling thread as realtime (nested calls are fine).
+    void Enter(const char* Where);
+    void Leave();
+
+    //R1.01 Record a violation if the calling thread is marked realtime. Never allocates.
+    void Violation(int Type, const char* What);
+
+    //R1.01 Each plugin instance calls Start/Stop. The report thread runs while anyone needs it.
+    void Start();
+    void Stop();
+
+    //R1.01 Violations found since the process started.
+    int Count();
+
+    struct Scope
+    {
+        explicit Scope(const char* Where) { Enter(Where); }
+        ~Scope() { Leave(); }
+    };
+}
+
+#define MAKO_AUDIT_JOIN2(a, b) a##b
+#define MAKO_AUDIT_JOIN(a, b) MAKO_AUDIT_JOIN2(a, b)
+#define MAKO_AUDIT_SCOPE(Where) MakoAudit::Scope MAKO_AUDIT_JOIN(MakoAuditScope_, __LINE__) (Where)
+#define MAKO_AUDIT_LOCK(What) MakoAudit::Violation(MakoAudit::e_Lock, What)
+#define MAKO_AUDIT_START() MakoAudit::Start()
+#define MAKO_AUDIT_STOP() MakoAudit::Stop()
+
+#else
+
+#define MAKO_AUDIT_SCOPE(Where)
+#define MAKO_AUDIT_LOCK(What)
+#define MAKO_AUDIT_START()
+#define MAKO_AUDIT_STOP()
+
+#endif
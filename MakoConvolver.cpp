@@ -0,0 +1,575 @@
+/*
+  ==============================================================================
+
+    MakoConvolver.cpp
+    R1.01 Cabinet IR convolution. See MakoConvolver.h for how it works.
+
+  ==============================================================================
+*/
+
+#include "MakoConvolver.h"
+#include "MakoAudit.h"
+#include "MakoWake.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+//R1.01 Longest IR we will use. Cab IRs are normally well under half a second.
+static const double IR_MaxSeconds = 1.0;
+
+//==============================================================================
+//R1.01 FFT
+//==============================================================================
+MakoFFT::MakoFFT(int size) : Size(size), Twiddle(size_t(size / 2)), BitRev(size_t(size))
+{
+    int Bits = 0;
+    while ((1 << Bits) < Size) Bits++;
+
+    for (int i = 0; i < Size; i++)
+    {
+        int r = 0;
+        for (int b = 0; b < Bits; b++)
+            if ((i >> b) & 1) r |= 1 << (Bits - 1 - b);
+        BitRev[size_t(i)] = r;
+    }
+
+    for (int k = 0; k < Size / 2; k++)
+        Twiddle[size_t(k)] = std::polar(1.0f, float(-6.283185307179586 * k / Size));
+}
+
+void MakoFFT::Run(tp_cpx* Data, bool Inverse) const
+{
+    for (int i = 0; i < Size; i++)
+        if (i < BitRev[size_t(i)]) std::swap(Data[i], Data[BitRev[size_t(i)]]);
+
+    for (int Len = 2; Len <= Size; Len <<= 1)
+    {
+        int Half = Len >> 1;
+        int Step = Size / Len;
+
+        for (int i = 0; i < Size; i += Len)
+        {
+            for (int j = 0; j < Half; j++)
+            {
+                tp_cpx w = Twiddle[size_t(j * Step)];
+                if (Inverse) w = std::conj(w);
+
+                tp_cpx u = Data[i + j];
+                tp_cpx v = Data[i + j + Half] * w;
+                Data[i + j] = u + v;
+                Data[i + j + Half] = u - v;
+            }
+        }
+    }
+}
+
+//R1.01 Acc += A * B for N complex bins. Written out so it vectorizes.
+static void Cpx_MulAdd(tp_cpx* Acc, const tp_cpx* A, const tp_cpx* B, int N)
+{
+    float* pAcc = reinterpret_cast<float*>(Acc);
+    const float* pA = reinterpret_cast<const float*>(A);
+    const float* pB = reinterpret_cast<const float*>(B);
+
+    for (int k = 0; k < N * 2; k += 2)
+    {
+        pAcc[k] += pA[k] * pB[k] - pA[k + 1] * pB[k + 1];
+        pAcc[k + 1] += pA[k] * pB[k + 1] + pA[k + 1] * pB[k];
+    }
+}
+
+//==============================================================================
+//R1.01 SHARED IR CACHE
+//==============================================================================
+struct tp_ircache
+{
+    std::mutex Lock;
+    std::vector<std::weak_ptr<const MakoIR>> IRs;
+};
+
+static tp_ircache& IR_Cache()
+{
+    static tp_ircache Cache;
+    return Cache;
+}
+
+std::shared_ptr<const MakoIR> MakoIR_Find(const std::string& Key, double SampleRate)
+{
+    auto& Cache = IR_Cache();
+    MAKO_AUDIT_LOCK("IR cache");
+    std::lock_guard<std::mutex> Lock(Cache.Lock);
+
+    for (auto& Weak : Cache.IRs)
+    {
+        auto IR = Weak.lock();
+        if ((IR != nullptr) && (IR->Key == Key) && (IR->SampleRate == SampleRate)) return IR;
+    }
+    return nullptr;
+}
+
+//R1.01 Windowed sinc (Blackman) resampler. Low passes when going down in rate.
+static std::vector<float> IR_Resample(const float* Samples, int Count, double FileRate, double SampleRate)
+{
+    double Ratio = SampleRate / FileRate;
+    int OutCount = std::min(int(Count * Ratio + .5), int(SampleRate * IR_MaxSeconds));
+    std::vector<float> Out(size_t(std::max(0, OutCount)));
+
+    if (Ratio == 1.0)
+    {
+        std::copy(Samples, Samples + OutCount, Out.begin());
+        return Out;
+    }
+
+    const double pi = 3.141592653589793;
+    double Fc = std::min(1.0, Ratio);
+    int Half = int(std::ceil(16.0 / Fc));
+
+    for (int i = 0; i < OutCount; i++)
+    {
+        double t = i / Ratio;
+        int Center = int(std::floor(t));
+        double Sum = 0.0;
+
+        for (int k = Center - Half + 1; k <= Center + Half; k++)
+        {
+            if ((k < 0) || (Count <= k)) continue;
+
+            double d = t - k;
+            double x = d / Half;
+            if (1.0 <= std::fabs(x)) continue;
+
+            double Sinc = (d == 0.0) ? 1.0 : std::sin(pi * Fc * d) / (pi * Fc * d);
+            double Win = .42 + .5 * std::cos(pi * x) + .08 * std::cos(2.0 * pi * x);
+            Sum += Samples[k] * Fc * Sinc * Win;
+        }
+        Out[size_t(i)] = float(Sum);
+    }
+    return Out;
+}
+
+//R1.01 Cut the IR into FFT partitions of Part taps starting at tap Start. Spectra include the 1/N scaling.
+static int IR_Partition(const std::vector<float>& h, int Start, int End, int Part, const MakoFFT& Fft, std::vector<tp_cpx>& Spec)
+{
+    int Parts = (End <= Start) ? 0 : (End - Start + Part - 1) / Part;
+    float Scale = 1.0f / float(Part * 2);
+
+    Spec.assign(size_t(Parts * Part * 2), tp_cpx());
+    for (int p = 0; p < Parts; p++)
+    {
+        tp_cpx* S = &Spec[size_t(p * Part * 2)];
+        for (int i = 0; i < Part; i++)
+        {
+            int Tap = Start + p * Part + i;
+            if (Tap < End) S[i] = tp_cpx(h[size_t(Tap)] * Scale, 0.0f);
+        }
+        Fft.Forward(S);
+    }
+    return Parts;
+}
+
+std::shared_ptr<const MakoIR> MakoIR_Build(const std::string& Key, const float* Samples, int Count, double FileRate, double SampleRate)
+{
+    //R1.01 Someone else may already have built it.
+    auto Found = MakoIR_Find(Key, SampleRate);
+    if (Found != nullptr) return Found;
+
+    //R1.01 Large partitions are about 21 mS at any sample rate, so the background thread always has the same time.
+    int Large = 1024;
+    while (Large * 48000.0 < 1024 * SampleRate * .99) Large *= 2;
+
+    auto IR = std::make_shared<MakoIR>(Large);
+    std::vector<float> h = IR_Resample(Samples, Count, FileRate, SampleRate);
+
+    IR->Key = Key;
+    IR->SampleRate = SampleRate;
+    IR->Length = int(h.size());
+
+    for (int m = 0; m < MakoIR::Head; m++)
+        IR->HeadRev[m] = (MakoIR::Head - 1 - m < IR->Length) ? h[size_t(MakoIR::Head - 1 - m)] : 0.0f;
+
+    IR->Parts1 = IR_Partition(h, MakoIR::Head, std::min(IR->Length, IR->LargeStart), MakoIR::Small, IR->Fft1, IR->Spec1);
+    IR->Parts2 = IR_Partition(h, IR->LargeStart, IR->Length, IR->Large, IR->Fft2, IR->Spec2);
+
+    auto& Cache = IR_Cache();
+    MAKO_AUDIT_LOCK("IR cache");
+    std::lock_guard<std::mutex> Lock(Cache.Lock);
+    Cache.IRs.erase(std::remove_if(Cache.IRs.begin(), Cache.IRs.end(), [](const std::weak_ptr<const MakoIR>& w) { return w.expired(); }), Cache.IRs.end());
+    Cache.IRs.push_back(IR);
+    return IR;
+}
+
+//==============================================================================
+//R1.01 WORKER CREW.
+//==============================================================================
+namespace
+{
+    //R1.01 One set of worker threads with their own wake up and quit flag. A new set can start while
+    //R1.01 the last one is still being joined, they never share a flag or steal each other's wake ups.
+    struct tp_crew
+    {
+        MakoWake Wake;
+        std::atomic<bool> Quit{ false };
+        std::vector<std::thread> Threads;
+    };
+}
+
+//==============================================================================
+//R1.01 LARGE PARTITION TAIL. Filled by the audio thread, run by a background worker.
+//==============================================================================
+struct MakoConvolver::tp_tail
+{
+    static const int Ring = 4;
+
+    std::shared_ptr<const MakoIR> IR;
+    int Large = 0;
+
+    //R1.01 The workers we post our jobs to, set when registered.
+    std::shared_ptr<tp_crew> Crew;
+
+    //R1.01 Input blocks from the audio thread. Single producer, single consumer.
+    std::vector<tp_cpx> JobIn[Ring];
+    unsigned int JobSeq[Ring] = {};
+    std::atomic<unsigned int> JobWrite{ 0 };
+    std::atomic<unsigned int> JobRead{ 0 };
+
+    //R1.01 Finished output blocks back to the audio thread.
+    std::vector<tp_cpx> ResOut[Ring];
+    unsigned int ResSeq[Ring] = {};
+    std::atomic<unsigned int> ResWrite{ 0 };
+    std::atomic<unsigned int> ResRead{ 0 };
+
+    //R1.01 Only one worker runs a tail at a time. Dead means our convolver is gone.
+    std::atomic<bool> Busy{ false };
+    std::atomic<bool> Dead{ false };
+
+    //R1.01 Worker only.
+    std::vector<tp_cpx> Prev;
+    std::vector<tp_cpx> Fdl;
+    std::vector<tp_cpx> Acc;
+    int FdlPos = 0;
+    unsigned int NextSeq = 0;
+
+    explicit tp_tail(std::shared_ptr<const MakoIR> ir) : IR(ir), Large(ir->Large)
+    {
+        for (int r = 0; r < Ring; r++)
+        {
+            JobIn[r].assign(size_t(Large), tp_cpx());
+            ResOut[r].assign(size_t(Large), tp_cpx());
+        }
+        Prev.assign(size_t(Large), tp_cpx());
+        Fdl.assign(size_t(IR->Parts2 * Large * 2), tp_cpx());
+        Acc.assign(size_t(Large * 2), tp_cpx());
+    }
+
+    //R1.01 A job is waiting.
+    bool Pending() const { return JobRead.load() != JobWrite.load(); }
+
+    //R1.01 Run every job that is waiting, as long as there is room for the result.
+    bool Run_Jobs()
+    {
+        bool Did = false;
+        int N = Large * 2;
+        int Parts = IR->Parts2;
+
+        while (true)
+        {
+            unsigned int jr = JobRead.load(std::memory_order_relaxed);
+            if (jr == JobWrite.load(std::memory_order_acquire)) break;
+
+            unsigned int rw = ResWrite.load(std::memory_order_relaxed);
+            if (rw - ResRead.load(std::memory_order_acquire) >= unsigned(Ring)) break;
+
+            const std::vector<tp_cpx>& In = JobIn[jr % Ring];
+            unsigned int Seq = JobSeq[jr % Ring];
+
+            //R1.01 The audio thread had to drop a block. Start the delay line over.
+            if (Seq != NextSeq)
+            {
+                std::fill(Fdl.begin(), Fdl.end(), tp_cpx());
+                std::fill(Prev.begin(), Prev.end(), tp_cpx());
+            }
+
+            //R1.01 Overlap save: [previous block | this block].
+            tp_cpx* Slot = &Fdl[size_t(FdlPos * N)];
+            std::copy(Prev.begin(), Prev.end(), Slot);
+            std::copy(In.begin(), In.end(), Slot + Large);
+            std::copy(In.begin(), In.end(), Prev.begin());
+            JobRead.store(jr + 1, std::memory_order_release);
+            IR->Fft2.Forward(Slot);
+
+            std::fill(Acc.begin(), Acc.end(), tp_cpx());
+            for (int p = 0; p < Parts; p++)
+            {
+                int s = (FdlPos - p + Parts) % Parts;
+                Cpx_MulAdd(Acc.data(), &Fdl[size_t(s * N)], &IR->Spec2[size_t(p * N)], N);
+            }
+            IR->Fft2.Inverse(Acc.data());
+            FdlPos = (FdlPos + 1) % Parts;
+
+            std::copy(Acc.begin() + Large, Acc.end(), ResOut[rw % Ring].begin());
+            ResSeq[rw % Ring] = Seq;
+            ResWrite.store(rw + 1, std::memory_order_release);
+
+            NextSeq = Seq + 1;
+            Did = true;
+        }
+        return Did;
+    }
+};
+
+//==============================================================================
+//R1.01 WORKER POOL. Shared by every convolver in the process. Workers sleep until a convolver posts
+//R1.01 a large partition (about every 21 mS per convolver), so silent or stopped instances cost nothing.
+//==============================================================================
+namespace
+{
+    struct tp_pool
+    {
+        std::mutex Lock;
+        std::vector<std::shared_ptr<MakoConvolver::tp_tail>> Tails;
+        std::shared_ptr<tp_crew> Crew;
+
+        void Run(tp_crew* C)
+        {
+            std::vector<std::shared_ptr<MakoConvolver::tp_tail>> Snap;
+
+            while (true)
+            {
+                C->Wake.Wait();
+                if (C->Quit.load()) break;
+
+                {
+                    std::lock_guard<std::mutex> L(Lock);
+                    Snap = Tails;
+                }
+
+                //R1.01 Check again after letting go of Busy. A job posted while we held it woke a worker
+                //R1.01 that skipped this tail, so nobody else will run it.
+                for (auto& T : Snap)
+                {
+                    while (!T->Dead.load() && T->Pending())
+                    {
+                        bool Expected = false;
+                        if (!T->Busy.compare_exchange_strong(Expected, true)) break;
+                        bool Did = T->Run_Jobs();
+                        T->Busy.store(false);
+                        if (!Did) break;
+                    }
+                }
+                Snap.clear();
+            }
+        }
+
+        void Register(std::shared_ptr<MakoConvolver::tp_tail> Tail)
+        {
+            MAKO_AUDIT_LOCK("convolver pool");
+            std::lock_guard<std::mutex> L(Lock);
+            if (Crew == nullptr)
+            {
+                Crew = std::make_shared<tp_crew>();
+                unsigned int Count = std::max(1u, std::min(4u, std::thread::hardware_concurrency() / 2));
+                for (unsigned int t = 0; t < Count; t++) Crew->Threads.emplace_back([this, C = Crew.get()] { Run(C); });
+            }
+            Tail->Crew = Crew;
+            Tails.push_back(Tail);
+        }
+
+        void Unregister(MakoConvolver::tp_tail* Tail)
+        {
+            std::shared_ptr<tp_crew> Done;
+            MAKO_AUDIT_LOCK("convolver pool");
+            {
+                std::lock_guard<std::mutex> L(Lock);
+                Tail->Dead.store(true);
+                Tails.erase(std::remove_if(Tails.begin(), Tails.end(), [Tail](const std::shared_ptr<MakoConvolver::tp_tail>& t) { return t.get() == Tail; }), Tails.end());
+                if (Tails.empty()) Done.swap(Crew);
+            }
+            if (Done == nullptr) return;
+
+            Done->Quit.store(true);
+            for (size_t t = 0; t < Done->Threads.size(); t++) Done->Wake.Post();
+            for (auto& T : Done->Threads) T.join();
+        }
+    };
+
+    tp_pool& Pool()
+    {
+        static tp_pool P;
+        return P;
+    }
+}
+
+//==============================================================================
+//R1.01 CONVOLVER
+//==============================================================================
+MakoConvolver::MakoConvolver(std::shared_ptr<const MakoIR> ir) : IR(ir)
+{
+    In1.assign(size_t(MakoIR::Small * 2), tp_cpx());
+    Fdl1.assign(size_t(IR->Parts1 * MakoIR::Small * 2), tp_cpx());
+    Work1.assign(size_t(MakoIR::Small * 2), tp_cpx());
+    Out1.assign(size_t(MakoIR::Small), tp_cpx());
+
+    In2.assign(size_t(IR->Large), tp_cpx());
+    Out2.assign(size_t(IR->Large), tp_cpx());
+
+    if (0 < IR->Parts2)
+    {
+        Tail = std::make_shared<tp_tail>(IR);
+        Pool().Register(Tail);
+    }
+}
+
+MakoConvolver::~MakoConvolver()
+{
+    if (Tail != nullptr) Pool().Unregister(Tail.get());
+}
+
+void MakoConvolver::Process(float* L, float* R, int Samples)
+{
+    const int H = MakoIR::Head;
+    const float* HeadRev = IR->HeadRev;
+
+    for (int n = 0; n < Samples; n++)
+    {
+        float xl = L[n];
+        float xr = (R != nullptr) ? R[n] : xl;
+
+        //R1.01 Direct form head, taps 0 - 63.
+        HistL[HistPos] = HistL[HistPos + H] = xl;
+        HistR[HistPos] = HistR[HistPos + H] = xr;
+        const float* hl = HistL + HistPos + 1;
+        const float* hr = HistR + HistPos + 1;
+        float yl = 0.0f;
+        float yr = 0.0f;
+        for (int m = 0; m < H; m++)
+        {
+            yl += HeadRev[m] * hl[m];
+            yr += HeadRev[m] * hr[m];
+        }
+        HistPos = (HistPos + 1) % H;
+
+        //R1.01 Add the partitioned parts worked out from earlier blocks.
+        yl += Out1[size_t(Pos1)].real() + Out2[size_t(Pos2)].real();
+        yr += Out1[size_t(Pos1)].imag() + Out2[size_t(Pos2)].imag();
+
+        In1[size_t(MakoIR::Small + Pos1)] = tp_cpx(xl, xr);
+        In2[size_t(Pos2)] = tp_cpx(xl, xr);
+
+        if (++Pos1 == MakoIR::Small)
+        {
+            Small_Block();
+            Pos1 = 0;
+        }
+        if (++Pos2 == IR->Large)
+        {
+            Large_Block();
+            Pos2 = 0;
+        }
+
+        L[n] = yl;
+        if (R != nullptr) R[n] = yr;
+    }
+}
+
+void MakoConvolver::Reset()
+{
+    std::fill(std::begin(HistL), std::end(HistL), 0.0f);
+    std::fill(std::begin(HistR), std::end(HistR), 0.0f);
+    HistPos = 0;
+
+    std::fill(In1.begin(), In1.end(), tp_cpx());
+    std::fill(Fdl1.begin(), Fdl1.end(), tp_cpx());
+    std::fill(Out1.begin(), Out1.end(), tp_cpx());
+    Pos1 = 0;
+    Fdl1_Pos = 0;
+
+    //R1.01 Skip more block numbers than the rings hold, so every old job and result is seen as stale.
+    std::fill(In2.begin(), In2.end(), tp_cpx());
+    std::fill(Out2.begin(), Out2.end(), tp_cpx());
+    Pos2 = 0;
+    Seq2 += unsigned(tp_tail::Ring) * 2;
+    Seq2_Start = Seq2;
+
+    //R1.01 Results already back are no use now, free their slots for the worker.
+    if (Tail != nullptr) Tail->ResRead.store(Tail->ResWrite.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+//R1.01 A small block is complete. Work out the small partitions' output for the next block.
+void MakoConvolver::Small_Block()
+{
+    const int S = MakoIR::Small;
+    const int N = S * 2;
+    const int Parts = IR->Parts1;
+
+    if (Parts == 0) return;
+
+    tp_cpx* Slot = &Fdl1[size_t(Fdl1_Pos * N)];
+    std::copy(In1.begin(), In1.end(), Slot);
+    std::copy(In1.begin() + S, In1.end(), In1.begin());
+    IR->Fft1.Forward(Slot);
+
+    std::fill(Work1.begin(), Work1.end(), tp_cpx());
+    for (int p = 0; p < Parts; p++)
+    {
+        int s = (Fdl1_Pos - p + Parts) % Parts;
+        Cpx_MulAdd(Work1.data(), &Fdl1[size_t(s * N)], &IR->Spec1[size_t(p * N)], N);
+    }
+    IR->Fft1.Inverse(Work1.data());
+    std::copy(Work1.begin() + S, Work1.end(), Out1.begin());
+
+    Fdl1_Pos = (Fdl1_Pos + 1) % Parts;
+}
+
+//R1.01 A large block is complete. Hand it to the worker, and pick up the worker's
+//R1.01 output for the block before it, which is what we play over the next block.
+void MakoConvolver::Large_Block()
+{
+    if (Tail == nullptr) return;
+
+    tp_tail& T = *Tail;
+    const int Ring = tp_tail::Ring;
+
+    unsigned int jw = T.JobWrite.load(std::memory_order_relaxed);
+    if (jw - T.JobRead.load(std::memory_order_acquire) < unsigned(Ring))
+    {
+        std::copy(In2.begin(), In2.end(), T.JobIn[jw % Ring].begin());
+        T.JobSeq[jw % Ring] = Seq2;
+        T.JobWrite.store(jw + 1, std::memory_order_release);
+        T.Crew->Wake.Post();
+    }
+    else
+        Miss_Count.fetch_add(1, std::memory_order_relaxed);
+
+    bool Found = false;
+    unsigned int Want = Seq2 - 1;
+    while ((Seq2 != Seq2_Start) && (T.ResRead.load(std::memory_order_relaxed) != T.ResWrite.load(std::memory_order_acquire)))
+    {
+        unsigned int rr = T.ResRead.load(std::memory_order_relaxed);
+        int Age = int(T.ResSeq[rr % Ring] - Want);
+
+        //R1.01 A result that came in too late, throw it away.
+        if (Age < 0)
+        {
+            T.ResRead.store(rr + 1, std::memory_order_release);
+            continue;
+        }
+
+        if (Age == 0)
+        {
+            std::copy(T.ResOut[rr % Ring].begin(), T.ResOut[rr % Ring].end(), Out2.begin());
+            T.ResRead.store(rr + 1, std::memory_order_release);
+            Found = true;
+        }
+        break;
+    }
+
+    if (!Found)
+    {
+        std::fill(Out2.begin(), Out2.end(), tp_cpx());
+        if (Seq2 != Seq2_Start) Miss_Count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Seq2++;
+}
@@ -0,0 +1,137 @@
+/*
+  ==============================================================================
+
+    MakoConvolver.h
+    R1.01 Cabinet impulse response (IR) convolution.
+
+    Zero latency, non-uniform partitioned convolution:
+    * Taps 0 - 63 are done directly (time domain) so there is no delay.
+    * Taps 64 - 2047 use 64 sample FFT partitions, done on the audio thread.
+    * The rest of the IR uses 1024 sample FFT partitions (2048 at 96k), done on
+      a background thread. Those partitions start two partitions in, so the
+      background thread has a full partition of time to finish each one before
+      the audio thread needs it.
+
+    Left and Right are packed into one complex signal (L + iR). The IR is real,
+    so one complex FFT convolves both channels at once.
+
+    IRs are resampled to the plugin sample rate and split into partitions once,
+    then shared by every instance that loads the same file.
+
+    Plain C++, no JUCE needed.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <complex>
+#include <memory>
+#include <string>
+#include <vector>
+
+typedef std::complex<float> tp_cpx;
+
+//R1.01 Simple radix 2 complex FFT. Twiddles and bit reverse table are precalculated for one size.
+class MakoFFT
+{
+public:
+    explicit MakoFFT(int size);
+
+    //R1.01 In place. Inverse is not scaled, the 1/N is folded into our IR spectra.
+    void Forward(tp_cpx* Data) const { Run(Data, false); }
+    void Inverse(tp_cpx* Data) const { Run(Data, true); }
+
+    int Size;
+
+private:
+    void Run(tp_cpx* Data, bool Inverse) const;
+    std::vector<tp_cpx> Twiddle;
+    std::vector<int> BitRev;
+};
+
+//R1.01 One impulse response at one sample rate, ready to convolve. Never changes once built.
+struct MakoIR
+{
+    static const int Head = 64;            //R1.01 Direct form taps, also the small partition size.
+    static const int Small = 64;           //R1.01 Small partition size (audio thread).
+
+    //R1.01 Large partition size (background thread), 1024 at 48k and doubled for higher rates.
+    explicit MakoIR(int large) : Large(large), LargeStart(large * 2), Fft2(large * 2) {}
+    const int Large;
+    const int LargeStart;                  //R1.01 First tap done by the large partitions.
+
+    std::string Key;
+    double SampleRate = 0.0;
+    int Length = 0;
+
+    float HeadRev[Head] = {};              //R1.01 First taps, reversed for a straight dot product.
+    int Parts1 = 0;                        //R1.01 Small partitions, each Small * 2 bins.
+    std::vector<tp_cpx> Spec1;
+    int Parts2 = 0;                        //R1.01 Large partitions, each Large * 2 bins.
+    std::vector<tp_cpx> Spec2;
+
+    MakoFFT Fft1{ Small * 2 };
+    MakoFFT Fft2;
+};
+
+//R1.01 Find an IR already built for this file and sample rate (any instance may have built it).
+std::shared_ptr<const MakoIR> MakoIR_Find(const std::string& Key, double SampleRate);
+
+//R1.01 Resample mono IR samples to SampleRate, partition them and add them to the shared cache.
+//R1.01 Message thread only, this allocates and runs FFTs.
+std::shared_ptr<const MakoIR> MakoIR_Build(const std::string& Key, const float* Samples, int Count, double FileRate, double SampleRate);
+
+//R1.01 The convolution state for one plugin instance.
+class MakoConvolver
+{
+public:
+    explicit MakoConvolver(std::shared_ptr<const MakoIR> ir);
+    ~MakoConvolver();
+
+    //R1.01 Convolve in place. R can be nullptr for mono. Zero latency. Audio thread, never allocates or locks.
+    void Process(float* L, float* R, int Samples);
+
+    //R1.01 Forget all input so far, as if it had been silent forever. Audio thread, never allocates or waits.
+    //R1.01 The background thread is told by a gap in the block numbers, and drops anything still in flight.
+    void Reset();
+
+    //R1.01 Number of times the background thread was late and a tail block was skipped.
+    int Misses() const { return Miss_Count.load(std::memory_order_relaxed); }
+
+    const MakoIR& GetIR() const { return *IR; }
+
+    //R1.01 The large partitions are run by shared background workers. The state they use lives in here
+    //R1.01 and is reference counted, so a worker can finish a job even if we are deleted meanwhile.
+    struct tp_tail;
+
+private:
+    std::shared_ptr<const MakoIR> IR;
+    std::shared_ptr<tp_tail> Tail;
+
+    //R1.01 Direct form head. History is written twice so the last Head samples are always in one piece.
+    float HistL[MakoIR::Head * 2] = {};
+    float HistR[MakoIR::Head * 2] = {};
+    int HistPos = 0;
+
+    //R1.01 Small partitions: input block, frequency domain delay line and the output for the next block.
+    std::vector<tp_cpx> In1;
+    std::vector<tp_cpx> Fdl1;
+    std::vector<tp_cpx> Work1;
+    std::vector<tp_cpx> Out1;
+    int Pos1 = 0;
+    int Fdl1_Pos = 0;
+
+    //R1.01 Large partitions: input block for the worker and the output it gave us.
+    std::vector<tp_cpx> In2;
+    std::vector<tp_cpx> Out2;
+    int Pos2 = 0;
+    unsigned int Seq2 = 0;
+    unsigned int Seq2_Start = 0;           //R1.01 First block number since the start or the last Reset.
+
+    std::atomic<int> Miss_Count{ 0 };
+
+    void Small_Block();
+    void Large_Block();
+};
@@ -0,0 +1,1492 @@
+/*
+  ==============================================================================
+
+    MakoEngine.cpp
+    R1.01 The MakoPrecog DSP chain. See MakoEngine.h.
+
+  ==============================================================================
+*/
+
+#include "MakoEngine.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "MakoTrace.h"          //R1.01 Stage trace markers, compile to nothing unless MAKO_TRACE=1.
+#include "MakoAudit.h"          //R1.01 Realtime safety audit, compiles to nothing unless MAKO_AUDIT=1.
+#include "MakoWake.h"           //R1.01 Coefficient thread wake up.
+
+#if MAKO_KERNELS_X86
+ #include <xmmintrin.h>
+#endif
+
+//R1.01 Flush denormals to zero while we run and put the caller's mode back after, like juce::ScopedNoDenormals.
+//R1.01 Filter tails decaying into denormals would otherwise cost far more than the filters.
+//R1.01 Writing the mode is slow on some CPUs, so it is only written when the host has not set it already.
+struct tp_nodenormals
+{
+#if MAKO_KERNELS_X86
+    unsigned int Saved = _mm_getcsr();
+    bool Change = ((Saved & 0x8040) != 0x8040);         //R1.01 FTZ and DAZ.
+    tp_nodenormals() { if (Change) _mm_setcsr(Saved | 0x8040); }
+    ~tp_nodenormals() { if (Change) _mm_setcsr(Saved); }
+#endif
+};
+
+//==============================================================================
+//R1.01 COEFFICIENT THREAD. One for the whole process, refcounted by the engines registered with it.
+//==============================================================================
+struct MakoEngine::tp_coeffcrew
+{
+    MakoWake Wake;
+    std::atomic<bool> Quit{ false };
+    std::thread Thread;
+};
+
+//R1.01 A new crew can start while the last one is still being joined, they never share a quit flag or wake up.
+struct MakoEngine::tp_coeffpool
+{
+    std::mutex Lock;
+    std::vector<MakoEngine*> Engines;
+    std::shared_ptr<tp_coeffcrew> Crew;
+
+    static tp_coeffpool& Get()
+    {
+        static tp_coeffpool P;
+        return P;
+    }
+
+    //R1.01 Sleeps until an engine posts, then does only the flagged part of every dirty engine.
+    //R1.01 Lock is held for the whole pass, so an engine can not be unregistered (and deleted) under us.
+    void Run(tp_coeffcrew* C)
+    {
+        while (true)
+        {
+            C->Wake.Wait();
+            if (C->Quit.load()) break;
+
+            std::lock_guard<std::mutex> L(Lock);
+            for (MakoEngine* E : Engines)
+            {
+                if (E->Settings_Dirty.load() == 0) continue;
+                std::lock_guard<std::mutex> EL(E->Coeff_Lock);
+                uint32_t Bits = E->Settings_Dirty.exchange(0);
+                if (Bits != 0) E->Mako_Coeffs_Compute(Bits);
+            }
+        }
+    }
+
+    void Register(MakoEngine* E)
+    {
+        std::lock_guard<std::mutex> L(Lock);
+        if (Crew == nullptr)
+        {
+            Crew = std::make_shared<tp_coeffcrew>();
+            Crew->Thread = std::thread([this, C = Crew.get()] { Run(C); });
+        }
+        E->Coeff_Crew = Crew;
+        Engines.push_back(E);
+    }
+
+    void Unregister(MakoEngine* E)
+    {
+        std::shared_ptr<tp_coeffcrew> Done;
+        {
+            std::lock_guard<std::mutex> L(Lock);
+            Engines.erase(std::remove(Engines.begin(), Engines.end(), E), Engines.end());
+            if (Engines.empty()) Done.swap(Crew);
+        }
+        if (Done == nullptr) return;
+
+        Done->Quit.store(true);
+        Done->Wake.Post();
+        Done->Thread.join();
+    }
+};
+
+MakoEngine::MakoEngine()
+{
+    //R1.01 Start the trace dump thread (only when built with MAKO_TRACE=1).
+    MAKO_TRACE_START();
+
+    //R1.01 Start the realtime audit report thread (only when built with MAKO_AUDIT=1).
+    MAKO_AUDIT_START();
+
+    //R1.01 Plugin defaults. The dirty bits this sets are covered by the first full set below.
+    for (auto& P : Parm) P.store(0.0f);
+    SetParams(tp_params());
+    Settings_Dirty = 0;
+
+    //R1.01 First coefficient set and stage list, then the coefficient thread takes over.
+    Mako_Coeffs_Compute(Dirty_All);
+    tp_coeffpool::Get().Register(this);
+}
+
+MakoEngine::~MakoEngine()
+{
+    tp_coeffpool::Get().Unregister(this);
+    MAKO_TRACE_STOP();
+    MAKO_AUDIT_STOP();
+}
+
+//R1.01 Store a parameter and flag what it changes. Mono, bypass, quality and drive anti-aliasing are read
+//R1.01 by the audio thread as they are, everything else goes thru the coefficient thread.
+void MakoEngine::SetParam(int Id, float Value)
+{
+    if ((Id < 0) || (e_Parm_Count <= Id)) return;
+    Parm[Id].store(Value, std::memory_order_relaxed);
+
+    if (Id < e_Setting_Count)
+        Mako_Settings_Dirty(1u << Id);
+    else if ((Id == e_Parm_DetPeak) || (Id == e_Parm_DetRMS))
+        Mako_Settings_Dirty(1u << e_Dirty_Detector);
+    else if (Id == e_Parm_CompBands)
+        Mako_Settings_Dirty(1u << e_Dirty_Bands);
+    else if (Id == e_Parm_Density)
+        Mako_Settings_Dirty(1u << e_Dirty_Density);
+    else if ((Id == e_Parm_Chain) || (Id == e_Parm_DetPos))
+        Mako_Settings_Dirty(1u << e_Dirty_Chain);
+    else if (Id == e_Parm_Limiter)
+        Mako_Settings_Dirty(1u << e_Dirty_Limit);
+    else if ((Id == e_Parm_Dual) || (e_Parm_Right <= Id))
+        Mako_Settings_Dirty(1u << e_Dirty_Right);
+    else if ((e_Parm_DynEQ <= Id) && (Id < e_Parm_DriveAA))
+        Mako_Settings_Dirty(1u << e_Dirty_Dyn);
+}
+
+void MakoEngine::SetParams(const tp_params& P)
+{
+    SetParam(e_Gain, P.Gain);
+    SetParam(e_LowCut, P.LowCut);
+    SetParam(e_NGate, P.NGate);
+    SetParam(e_Drive, P.Drive);
+    SetParam(e_Comp1, P.Comp_Thresh);
+    SetParam(e_Comp2, P.Comp_Ratio);
+    SetParam(e_Low, P.Low);
+    SetParam(e_Mid, P.Mid);
+    SetParam(e_High, P.High);
+    SetParam(e_Parm_Chain, float(P.Chain));
+    SetParam(e_Parm_DetPos, float(P.DetPos));
+    SetParam(e_Parm_DetPeak, P.DetPeak_mS);
+    SetParam(e_Parm_DetRMS, P.DetRMS_mS);
+    SetParam(e_Parm_Mono, float(P.Mono));
+    SetParam(e_Parm_CompBands, float(P.CompBands - 1));
+    SetParam(e_Parm_Limiter, float(P.Limiter));
+    SetParam(e_Parm_Bypass, P.Bypass ? 1.0f : 0.0f);
+    SetParam(e_Parm_Quality, float(P.Quality));
+    SetParam(e_Parm_Density, P.Density ? 1.0f : 0.0f);
+    SetParam(e_Parm_DynEQ, P.DynEQ ? 1.0f : 0.0f);
+    for (int b = 0; b < 3; b++)
+    {
+        SetParam(e_Parm_DynThresh + b, P.Dyn_Thresh[b]);
+        SetParam(e_Parm_DynRatio + b, P.Dyn_Ratio[b]);
+        SetParam(e_Parm_DynAttack + b, P.Dyn_Attack_mS[b]);
+        SetParam(e_Parm_DynRelease + b, P.Dyn_Release_mS[b]);
+    }
+    SetParam(e_Parm_DriveAA, float(P.DriveAA));
+    SetParam(e_Parm_Dual, P.Dual ? 1.0f : 0.0f);
+    for (int t = 0; t < e_Setting_Count; t++) SetParam(e_Parm_Right + t, P.Right[t]);
+}
+
+MakoEngine::tp_params MakoEngine::GetParams() const
+{
+    tp_params P;
+    P.Gain = GetParam(e_Gain);
+    P.LowCut = GetParam(e_LowCut);
+    P.NGate = GetParam(e_NGate);
+    P.Drive = GetParam(e_Drive);
+    P.Comp_Thresh = GetParam(e_Comp1);
+    P.Comp_Ratio = GetParam(e_Comp2);
+    P.Low = GetParam(e_Low);
+    P.Mid = GetParam(e_Mid);
+    P.High = GetParam(e_High);
+    P.Chain = int(GetParam(e_Parm_Chain));
+    P.DetPos = int(GetParam(e_Parm_DetPos));
+    P.DetPeak_mS = GetParam(e_Parm_DetPeak);
+    P.DetRMS_mS = GetParam(e_Parm_DetRMS);
+    P.Mono = int(GetParam(e_Parm_Mono));
+    P.CompBands = 1 + int(GetParam(e_Parm_CompBands));
+    P.Limiter = int(GetParam(e_Parm_Limiter));
+    P.Bypass = (.5f <= GetParam(e_Parm_Bypass));
+    P.Quality = int(GetParam(e_Parm_Quality));
+    P.Density = (.5f <= GetParam(e_Parm_Density));
+    P.DynEQ = (.5f <= GetParam(e_Parm_DynEQ));
+    for (int b = 0; b < 3; b++)
+    {
+        P.Dyn_Thresh[b] = GetParam(e_Parm_DynThresh + b);
+        P.Dyn_Ratio[b] = GetParam(e_Parm_DynRatio + b);
+        P.Dyn_Attack_mS[b] = GetParam(e_Parm_DynAttack + b);
+        P.Dyn_Release_mS[b] = GetParam(e_Parm_DynRelease + b);
+    }
+    P.DriveAA = int(GetParam(e_Parm_DriveAA));
+    P.Dual = (.5f <= GetParam(e_Parm_Dual));
+    for (int t = 0; t < e_Setting_Count; t++) P.Right[t] = GetParam(e_Parm_Right + t);
+    return P;
+}
+
+void MakoEngine::Prepare(double sampleRate, int MaxBlock, int Channels)
+{
+    //R1.00 Get our Sample Rate for filter calculations.
+    //R1.01 The coefficient thread uses it too, so it waits until everything is redone at the new rate.
+    std::unique_lock<std::mutex> Lock(Coeff_Lock);
+    SampleRate = float(sampleRate);
+    if (SampleRate < 21000) SampleRate = 48000;
+    if (192000 < SampleRate) SampleRate = 48000;
+    Channel_Count = std::min(std::max(Channels, 1), 2);
+
+    //R1.00 Calculate some rough decay subtraction values for peak tracking (compress,autowah,etc).
+    Release_5mS = (1.0f / .005f) * (1.0f / SampleRate);
+    Release_10mS = (1.0f / .010f) * (1.0f / SampleRate);
+    Release_50mS = (1.0f / .05f) * (1.0f / SampleRate);
+    Release_100mS = (1.0f / .100f) * (1.0f / SampleRate);
+    Release_200mS = (1.0f / .200f) * (1.0f / SampleRate);
+    Release_300mS = (1.0f / .300f) * (1.0f / SampleRate);
+    Release_400mS = (1.0f / .400f) * (1.0f / SampleRate);
+    Release_500mS = (1.0f / .500f) * (1.0f / SampleRate);
+
+    //R1.01 Pick the DSP kernels once, here. The audio thread only ever calls thru this table.
+    Kernels = &MakoKernels::Get(Kernel_Force.load());
+
+    //R1.01 Start the true peak meter filters from silence.
+    TruePeak.Reset();
+
+    //R1.01 Get the coefficient tables shared by all instances at this sample rate.
+    CoeffTable = Mako_Tables_Get();
+
+    //R1.00 Update the adjustable values and filters.
+    //R1.01 Stage order and limiter lookahead too, the lookahead is in samples.
+    //R1.01 The audio thread picks the new set up at its first block.
+    Mako_Coeffs_Compute(Dirty_All);
+    Lock.unlock();
+
+    //R1.01 Bypass dry ring. Room for a block, the longest latency and the warm up run before it.
+    int Need = std::max(MaxBlock, Block_Max) + MakoLimiter::Latency(MakoLimiter::Ahead_Max) + Block_Max;
+    Byp_Size = 1;
+    while (Byp_Size < Need) Byp_Size <<= 1;
+    for (auto& Dry : Byp_Dry) Dry.assign(size_t(Byp_Size), 0.0f);
+    Byp_Write = 0;
+
+    //R1.01 Start in stereo, auto mono needs 50 mS of identical input.
+    Mono_Active = false;
+    Mono_Mix = 0.0f;
+    Mono_Same = 0;
+    Mono_Hold = std::max(1, int(.05f * SampleRate));
+
+    //R1.01 Tick at the first block.
+    Ctl_Count = 0;
+    Q_Elapsed = 0;
+}
+
+void MakoEngine::Process(float* const* Data, int Samples)
+{
+    tp_nodenormals NoDenormals;
+    MAKO_AUDIT_SCOPE("MakoEngine::Process");
+
+    //R1.00 Our defined variables.
+    float tS;  //R1.00 Temporary Sample.
+
+    //R1.01 Control tick. Big blocks tick every call, tiny ones every Ctl_Interval samples on average.
+    //R1.01 The call that ticks is the one timed for adaptive quality, from after the tick.
+    bool Timed = false;
+    std::chrono::steady_clock::time_point Q_Start;
+    if (Ctl_Count <= 0)
+    {
+        Mako_Control_Tick();
+        Ctl_Count = std::max(Ctl_Count, -Ctl_Interval) + Ctl_Interval;
+        Timed = true;
+        Q_Start = std::chrono::steady_clock::now();
+    }
+    Ctl_Count -= Samples;
+    Q_Elapsed += Samples;
+    const tp_stagelist& Stages = *Stages_Live;
+
+    int Channels = Channel_Count;
+
+    //R1.01 MONO fast path. Guitar DI is mono, so when both inputs are the same (or the user asks for it)
+    //R1.01 we only process the left channel and copy it to the right.
+    //R1.01 Not in DUAL MONO with different settings, the same input has to come out two ways.
+    //R1.01 Auto only goes mono after Mono_Hold samples in a row were the same on both sides, so nearly
+    //R1.01 identical stereo can not flip it every block. Any difference leaves mono at once.
+    int MonoMode = int(Parm[e_Parm_Mono].load(std::memory_order_relaxed));
+    bool Mono = false;
+    if ((Channels == 2) && Linked)
+    {
+        if (MonoMode == e_Mono_On) Mono = true;
+        if (MonoMode == e_Mono_Auto)
+        {
+            if (memcmp(Data[0], Data[1], sizeof(float) * size_t(Samples)) == 0)
+                Mono_Same = std::min(Mono_Same + Samples, Mono_Hold);
+            else
+                Mono_Same = 0;
+            Mono = (Mono_Hold <= Mono_Same);
+        }
+    }
+
+    //R1.01 Leaving mono, the right channel picks up where the left one is so nothing jumps.
+    //R1.01 Entering mono, the right channel keeps running on its own state while its output fades
+    //R1.01 over to the left one (Mono_Mix), only then does it stop.
+    if (Mono_Active && !Mono) Mako_State_CopyChannel(0, 1);
+    if (!Mono) Mono_Mix = 0.0f;
+    Mono_Active = Mono && (1.0f <= Mono_Mix);
+    int Outputs = Channels;
+    if (Mono_Active) Channels = 1;
+
+    //R1.01 BYPASS. Fully bypassed only our input, delayed by our latency, goes out. No DSP runs.
+    //R1.01 Coming back, everything starts from silence and the input just before this block is run
+    //R1.01 thru the chain first, so the filters, envelopes and limiter delay are already settled.
+    bool Bypass = Host_Bypass || (.5f <= Parm[e_Parm_Bypass].load(std::memory_order_relaxed));
+    int Lat = MakoLimiter::Latency(Limit_Ahead.load(std::memory_order_relaxed));
+    if (0 < Byp_Size)
+    {
+        if (Bypass && (1.0f <= Byp_Mix))
+        {
+            Mako_Bypass_Dry(Data, Outputs, Samples, Lat);
+            if (Metering) Mako_Meter_Frame(Samples);
+            return;
+        }
+        if (!Bypass && (1.0f <= Byp_Mix)) Mako_Bypass_Warm(Stages, Channels, Lat);
+
+        int Mask = Byp_Size - 1;
+        for (int channel = 0; channel < Outputs; channel++)
+            for (int samp = 0; samp < Samples; samp++) Byp_Dry[channel][size_t((Byp_Write + samp) & Mask)] = Data[channel][samp];
+        Byp_Write = (Byp_Write + Samples) & Mask;
+    }
+
+    //R1.01 Run each stage over the block in the current chain order.
+    //R1.01 Default is Low Cut -> Detector -> Gate -> EQ/Gain -> Compressor.
+    Mako_Stages_Run(Stages, Data, Channels, Samples);
+
+    //R1.00 Clip and track the loudest OUTPUT signal so far.
+    //R1.01 With the limiter on, the clip is only a safety net and never touches the signal.
+    for (int channel = 0; channel < Channels; ++channel)
+    {
+        auto* channelData = Data[channel];
+
+        for (int samp = 0; samp < Samples; samp++)
+        {
+            tS = channelData[samp];
+            if (1.0f < tS) tS = 1.0f;
+            if (tS < -1.0f) tS = -1.0f;
+            channelData[samp] = tS;
+        }
+
+        //R1.01 TRUE PEAK. The output meters and OV LED see the 4x oversampled peak,
+        //R1.01 so overs between samples show up too.
+        if (Metering)
+        {
+            float Peak = TruePeak.Process(channel, channelData, Samples);
+            if (VUValue[channel + 2] < Peak) VUValue[channel + 2] = Peak;
+        }
+    }
+
+    //R1.01 Fading into mono, 5 mS like bypass.
+    if (Mono && !Mono_Active)
+    {
+        float Step = 1.0f / (.005f * SampleRate);
+        float Mix = Mono_Mix;
+        for (int samp = 0; samp < Samples; samp++)
+        {
+            Mix = std::min(1.0f, Mix + Step);
+            Data[1][samp] += (Data[0][samp] - Data[1][samp]) * Mix;
+        }
+        Mono_Mix = Mix;
+    }
+
+    //R1.01 MONO: fan the left channel out to the right, meters included.
+    if (Channels < Outputs)
+    {
+        memcpy(Data[1], Data[0], sizeof(float) * size_t(Samples));
+        VUValue[1] = std::max(VUValue[1], VUValue[0]);
+        VUValue[3] = std::max(VUValue[3], VUValue[2]);
+    }
+
+    //R1.01 Crossfade to or from bypass.
+    if ((0 < Byp_Size) && (Bypass || (0.0f < Byp_Mix))) Mako_Bypass_Mix(Data, Outputs, Samples, Lat, Bypass);
+
+    //R1.01 Tell whoever is watching if the meters changed.
+    if (Metering) Mako_Meter_Frame(Samples);
+
+    //R1.01 Adaptive quality: see how long this block took.
+    if (Timed) Mako_Quality_Update(std::chrono::duration<double>(std::chrono::steady_clock::now() - Q_Start).count(), Samples);
+}
+
+//R1.01 CONTROL TICK. Everything that only has to happen at control rate.
+void MakoEngine::Mako_Control_Tick()
+{
+    //R1.00 Handle any changes to our Parameters made in the editor/DAW.
+    //R1.01 The coefficient thread did the math, we only copy a finished set in.
+    if (Coeffs.Fetch()) Mako_Coeffs_Apply(Coeffs.Reading());
+
+    //R1.01 Pick up a new stage order or cab IR if one was published.
+    Stage_Dispatch.Fetch();
+    Stages_Live = &Stage_Dispatch.Reading();
+    Cab.Fetch();
+    Cab_Live = Cab.Reading().get();
+
+    //R1.01 In HIGH DENSITY mode nobody looks at the meters while they are not watched.
+    //R1.01 The true peak history is stale after a pause, so it starts over.
+    bool Was_Metering = Metering;
+    Metering = Meter_Watched.load(std::memory_order_relaxed) || (Parm[e_Parm_Density].load(std::memory_order_relaxed) < .5f);
+    if (Metering && !Was_Metering) TruePeak.Reset();
+
+    //R1.01 The detector only runs if someone is going to read it.
+    Det_Active = Metering;
+    for (int channel = 0; channel < 2; channel++)
+        Det_Active = Det_Active || (0.0f < Setting[channel][e_NGate]) || (Setting[channel][e_Comp1] < 1.0f);
+    Comp_OwnDet = Stages_Live->CompOwnDet;
+
+    Ctl_Tier = Quality_Tier.load(std::memory_order_relaxed);
+
+    int Order = std::min(std::max(int(Parm[e_Parm_DriveAA].load(std::memory_order_relaxed)), 0), int(e_DriveAA_Count) - 1);
+    if (Order != AA_Order)
+    {
+        AA_Order = Order;
+        AA_State[0].Primed = AA_State[1].Primed = 0;
+    }
+}
+
+//R1.01 METER FRAME. Every 1/60 second hand the frame's peaks to the meters and start a new frame.
+//R1.01 Meter_Dirty is only set when something drawn would change, and never faster than the frame rate.
+void MakoEngine::Mako_Meter_Frame(int Samples)
+{
+    Meter_Count += Samples;
+    if (Meter_Count < int(SampleRate / 60.0f)) return;
+    Meter_Count = 0;
+
+    bool Post = false;
+    int Clip = 0;
+    for (int t = 0; t < 4; t++)
+    {
+        //R1.01 Bars are drawn as 0-100, a smaller change can not be seen.
+        int Shown = std::min(100, int(VUValue[t] * 100));
+        if (Shown != Meter_Shown[t])
+        {
+            Meter_Shown[t] = Shown;
+            Post = true;
+        }
+        if ((2 <= t) && (.99f < VUValue[t])) Clip |= 1 << (t - 2);
+        Meter_Level[t].store(VUValue[t], std::memory_order_relaxed);
+        VUValue[t] = 0.0f;
+    }
+
+    //R1.01 Any over has to relight (or hold) the OV LED.
+    Meter_Clip.store(Clip, std::memory_order_relaxed);
+    if (Clip != 0) Post = true;
+
+    //R1.01 Gain reduction of the compressor, the most any channel or band is turned down.
+    float Gain = 1.0f;
+    for (int channel = 0; channel < (Mono_Active ? 1 : Channel_Count); channel++)
+    {
+        if (Setting[channel][e_Comp1] < 1.0f)
+        {
+            if (1 < MB.Bands)
+                for (int b = 0; b < MB.Bands; b++) Gain = std::min(Gain, MB.GainAdj[channel][b]);
+            else
+                Gain = std::min(Gain, Dsp.Pedal_CompGainAdj[channel]);
+        }
+    }
+    float GR = 20.0f * std::log10(std::max(Gain, .00001f));
+    Meter_GR.store(GR, std::memory_order_relaxed);
+    int GR_Shown = int(GR * 2.0f);
+    if (GR_Shown != Meter_GR_Shown)
+    {
+        Meter_GR_Shown = GR_Shown;
+        Post = true;
+    }
+
+    int Tier = Quality_Tier.load(std::memory_order_relaxed);
+    if (Tier != Meter_Tier_Shown)
+    {
+        Meter_Tier_Shown = Tier;
+        Post = true;
+    }
+
+    if (Post && Meter_Watched.load(std::memory_order_relaxed)) Meter_Dirty.store(true, std::memory_order_release);
+}
+
+//R1.01 Big host blocks are cut into chunks so our detector buffers can be a fixed size.
+void MakoEngine::Mako_Stages_Run(const tp_stagelist& Stages, float* const* Data, int Channels, int Samples)
+{
+    for (int Start = 0; Start < Samples; Start += Block_Max)
+    {
+        int Count = std::min(Block_Max, Samples - Start);
+        float* Chunk[2] = {};
+        for (int channel = 0; channel < Channels; ++channel) Chunk[channel] = Data[channel] + Start;
+
+        for (int t = 0; t < Stages.Count; t++)
+        {
+            MAKO_TRACE_SCOPE(Stages.Name[t]);
+            (this->*Stages.Func[t])(Chunk, Channels, Count);
+        }
+    }
+}
+
+//R1.01 Fully bypassed. Each sample goes into the dry ring and comes back out Lat samples later.
+void MakoEngine::Mako_Bypass_Dry(float* const* Data, int Channels, int Samples, int Lat)
+{
+    int Mask = Byp_Size - 1;
+    for (int channel = 0; channel < Channels; channel++)
+    {
+        float* Dry = Byp_Dry[channel].data();
+        int w = Byp_Write;
+        for (int samp = 0; samp < Samples; samp++)
+        {
+            Dry[w] = Data[channel][samp];
+            Data[channel][samp] = Dry[(w - Lat) & Mask];
+            w = (w + 1) & Mask;
+        }
+    }
+    Byp_Write = (Byp_Write + Samples) & Mask;
+}
+
+//R1.01 Leaving bypass. Clear everything, then run the last Lat + Block_Max input samples thru the chain
+//R1.01 (meters off) so our output is right from the first sample of the fade in.
+void MakoEngine::Mako_Bypass_Warm(const tp_stagelist& Stages, int Channels, int Lat)
+{
+    alignas(16) float Buf[2][Block_Max];
+    float* Chunk[2] = { Buf[0], Buf[1] };
+    int Mask = Byp_Size - 1;
+    int Warm = Lat + Block_Max;
+    bool Was_Metering = Metering;
+
+    Mako_State_Reset();
+    Metering = false;
+
+    for (int Start = 0; Start < Warm; Start += Block_Max)
+    {
+        int Count = std::min(Block_Max, Warm - Start);
+        for (int channel = 0; channel < Channels; channel++)
+            for (int samp = 0; samp < Count; samp++) Buf[channel][samp] = Byp_Dry[channel][size_t((Byp_Write - Warm + Start + samp) & Mask)];
+
+        Mako_Stages_Run(Stages, Chunk, Channels, Count);
+    }
+
+    Metering = Was_Metering;
+}
+
+//R1.01 Crossfade between our output and the dry input (lined up by our latency) over 5 mS.
+void MakoEngine::Mako_Bypass_Mix(float* const* Data, int Channels, int Samples, int Lat, bool Bypass)
+{
+    float Target = Bypass ? 1.0f : 0.0f;
+    float Step = 1.0f / (.005f * SampleRate);
+    int Mask = Byp_Size - 1;
+    int Start = Byp_Write - Samples;
+    float Mix = Byp_Mix;
+
+    //R1.01 The host sent a bigger block than it promised and the dry ring has moved on. Rare, just switch.
+    if (Byp_Size < Samples + Lat)
+    {
+        Byp_Mix = Target;
+        return;
+    }
+
+    for (int channel = 0; channel < Channels; channel++)
+    {
+        const float* Dry = Byp_Dry[channel].data();
+        float* cD = Data[channel];
+        Mix = Byp_Mix;
+        for (int samp = 0; samp < Samples; samp++)
+        {
+            Mix = (Mix < Target) ? std::min(Target, Mix + Step) : std::max(Target, Mix - Step);
+            cD[samp] += (Dry[(Start + samp - Lat) & Mask] - cD[samp]) * Mix;
+        }
+    }
+    Byp_Mix = Mix;
+}
+
+//R1.01 ADAPTIVE QUALITY. Compare how long this block took with the time the block lasts.
+//R1.01 Over budget (or one block over twice the budget) steps down a tier, then waits half a second
+//R1.01 to see the effect. Two seconds under half the budget steps back up. The gap is our hysteresis.
+void MakoEngine::Mako_Quality_Update(double Used, int Samples)
+{
+    static const float Budget[e_Quality_Count] = { 1.0f, .10f, .25f, .50f };
+    int Mode = int(Parm[e_Parm_Quality].load(std::memory_order_relaxed));
+
+    int Elapsed = Q_Elapsed;
+    Q_Elapsed = 0;
+
+    if ((Mode <= e_Quality_Full) || (e_Quality_Count <= Mode) || (Samples <= 0))
+    {
+        Quality_Tier.store(e_Tier_Full, std::memory_order_relaxed);
+        Q_Load = 0.0f;
+        Q_Calm = 0;
+        return;
+    }
+
+    float Load = float(Used * SampleRate / Samples);
+    Q_Load += (Load - Q_Load) * .1f;
+    if (0 < Q_Hold) Q_Hold -= Elapsed;
+
+    int Tier = Quality_Tier.load(std::memory_order_relaxed);
+    if (((Budget[Mode] < Q_Load) || (2.0f * Budget[Mode] < Load)) && (Q_Hold <= 0))
+    {
+        if (Tier + 1 < e_Tier_Count) Quality_Tier.store(Tier + 1, std::memory_order_relaxed);
+        Q_Hold = int(SampleRate * .5f);
+        Q_Calm = 0;
+    }
+    else if (Q_Load < Budget[Mode] * .5f)
+    {
+        Q_Calm += Elapsed;
+        if ((int(SampleRate * 2.0f) < Q_Calm) && (0 < Tier))
+        {
+            Quality_Tier.store(Tier - 1, std::memory_order_relaxed);
+            Q_Hold = int(SampleRate * .5f);
+            Q_Calm = 0;
+        }
+    }
+    else
+        Q_Calm = 0;
+}
+
+//R1.01 Copy every bit of per channel state so a channel can carry on where another one is.
+void MakoEngine::Mako_State_CopyChannel(int From, int To)
+{
+    tp_filter* Filters[4] = { &Dsp.makoF_LowCut, &Dsp.makoF_Low, &Dsp.makoF_Mid, &Dsp.makoF_High };
+    for (auto* F : Filters)
+    {
+        F->xn0[To] = F->xn0[From];
+        F->xn1[To] = F->xn1[From];
+        F->xn2[To] = F->xn2[From];
+        F->yn1[To] = F->yn1[From];
+        F->yn2[To] = F->yn2[From];
+    }
+
+    for (int b = 0; b < 3; b++) Band_Mix[To][b] = Band_Mix[From][b];
+
+    //R1.01 The dynamic EQ has its own gains per channel in the EQ filters.
+    if (Dyn_Active)
+    {
+        for (int b = 1; b < 4; b++)
+        {
+            Filters[b]->a0[To] = Filters[b]->a0[From];
+            Filters[b]->a2[To] = Filters[b]->a2[From];
+        }
+    }
+    for (int b = 0; b < 4; b++)
+    {
+        Dyn_State.x1[To][b] = Dyn_State.x1[From][b];
+        Dyn_State.x2[To][b] = Dyn_State.x2[From][b];
+        Dyn_State.y1[To][b] = Dyn_State.y1[From][b];
+        Dyn_State.y2[To][b] = Dyn_State.y2[From][b];
+        Dyn_State.Env[To][b] = Dyn_State.Env[From][b];
+        Dyn_State.Step0[To][b] = Dyn_State.Step0[From][b];
+        Dyn_State.Step2[To][b] = Dyn_State.Step2[From][b];
+    }
+    AA_State[To] = AA_State[From];
+
+    Dsp.Pedal_NGate_Fac[To] = Dsp.Pedal_NGate_Fac[From];
+    Dsp.Det_Peak[To] = Dsp.Det_Peak[From];
+    Dsp.Det_MS[To] = Dsp.Det_MS[From];
+    Dsp.CompDet_Peak[To] = Dsp.CompDet_Peak[From];
+    Dsp.CompDet_MS[To] = Dsp.CompDet_MS[From];
+    Dsp.Pedal_CompGain[To] = Dsp.Pedal_CompGain[From];
+    Dsp.Pedal_CompGainAdj[To] = Dsp.Pedal_CompGainAdj[From];
+    TruePeak.CopyChannel(From, To);
+    Limiter.CopyChannel(From, To);
+
+    for (auto& F : MB.F)
+    {
+        for (int b = 0; b < 4; b++)
+        {
+            F.xn1[To][b] = F.xn1[From][b];
+            F.xn2[To][b] = F.xn2[From][b];
+            F.yn1[To][b] = F.yn1[From][b];
+            F.yn2[To][b] = F.yn2[From][b];
+        }
+    }
+    for (int b = 0; b < 4; b++)
+    {
+        MB.Env[To][b] = MB.Env[From][b];
+        MB.GainAdj[To][b] = MB.GainAdj[From][b];
+    }
+}
+
+//R1.01 Clear every bit of DSP state. The coefficients stay, they do not depend on the signal.
+void MakoEngine::Mako_State_Reset()
+{
+    tp_filter* Filters[4] = { &Dsp.makoF_LowCut, &Dsp.makoF_Low, &Dsp.makoF_Mid, &Dsp.makoF_High };
+    for (auto* F : Filters)
+    {
+        for (int channel = 0; channel < 2; channel++)
+            F->xn0[channel] = F->xn1[channel] = F->xn2[channel] = F->yn1[channel] = F->yn2[channel] = 0.0f;
+    }
+
+    for (int channel = 0; channel < 2; channel++)
+    {
+        Dsp.Pedal_NGate_Fac[channel] = 0.0f;
+        Dsp.Det_Peak[channel] = 0.0f;
+        Dsp.Det_MS[channel] = 0.0f;
+        Dsp.CompDet_Peak[channel] = 0.0f;
+        Dsp.CompDet_MS[channel] = 0.0f;
+        Dsp.Pedal_CompGain[channel] = 1.0f;
+        Dsp.Pedal_CompGainAdj[channel] = 1.0f;
+    }
+
+    for (auto& F : MB.F)
+    {
+        memset(F.xn1, 0, sizeof(F.xn1));
+        memset(F.xn2, 0, sizeof(F.xn2));
+        memset(F.yn1, 0, sizeof(F.yn1));
+        memset(F.yn2, 0, sizeof(F.yn2));
+    }
+    for (int channel = 0; channel < 2; channel++)
+    {
+        for (int b = 0; b < 4; b++)
+        {
+            MB.Env[channel][b] = 0.0f;
+            MB.GainAdj[channel][b] = 1.0f;
+        }
+    }
+
+    //R1.01 The dynamic EQ gains start from where they are, only the detectors start over.
+    memset(Dyn_State.x1, 0, sizeof(Dyn_State.x1));
+    memset(Dyn_State.x2, 0, sizeof(Dyn_State.x2));
+    memset(Dyn_State.y1, 0, sizeof(Dyn_State.y1));
+    memset(Dyn_State.y2, 0, sizeof(Dyn_State.y2));
+    memset(Dyn_State.Env, 0, sizeof(Dyn_State.Env));
+    AA_State[0].Primed = AA_State[1].Primed = 0;
+
+    TruePeak.Reset();
+    Limiter.Prepare(Limiter.GetAhead(), SampleRate);
+    if (Cab_Live != nullptr) Cab_Live->Reset();
+}
+
+//R1.01 LOW CUT stage. A setting of 20 Hz turns the filter off.
+//R1.01 With both channels on they are filtered together, each with its own coefficients.
+void MakoEngine::Mako_Stage_LowCut(float* const* Data, int Channels, int Samples)
+{
+    if ((Channels == 2) && (20.0f < Setting[0][e_LowCut]) && (20.0f < Setting[1][e_LowCut]))
+    {
+        Kernels->BiQuad2(Data, Samples, &Dsp.makoF_LowCut);
+        return;
+    }
+
+    for (int channel = 0; channel < Channels; channel++)
+        if (20.0f < Setting[channel][e_LowCut]) Kernels->BiQuad(Data[channel], Samples, &Dsp.makoF_LowCut, channel);
+}
+
+//R1.01 NOISE GATE stage. Reads the RMS envelope from the shared detector.
+void MakoEngine::Mako_Stage_Gate(float* const* Data, int Channels, int Samples)
+{
+    for (int channel = 0; channel < Channels; channel++)
+    {
+        float NGate = Setting[channel][e_NGate];
+        if (0.0f < NGate) Kernels->Gate(Data[channel], Env_RMS[channel], Samples, 1.1f - NGate, &Dsp.Pedal_NGate_Fac[channel]);
+    }
+}
+
+//R1.01 EQ, DRIVE and GAIN stage. Always on.
+//R1.01 Lower quality tiers use a cheaper tanh for the drive and skip EQ bands within 1 dB of flat.
+//R1.01 Anything switched on or off is crossfaded over Block_Max samples so tier changes do not click.
+void MakoEngine::Mako_Stage_EQGain(float* const* Data, int Channels, int Samples)
+{
+    tp_filter* Band[3] = { &Dsp.makoF_Low, &Dsp.makoF_Mid, &Dsp.makoF_High };
+    const float Step = 1.0f / float(Block_Max);
+
+    //R1.00 Apply our 3-band EQ to the signal.
+    //R1.01 Unless the DYNAMIC EQ is running it.
+    if (!Mako_Dyn_EQ(Data, Channels, Samples))
+    {
+        for (int b = 0; b < 3; b++)
+        {
+            bool On[2] = {};
+            bool Steady = true;
+            for (int channel = 0; channel < Channels; channel++)
+            {
+                float dB = Setting[channel][e_Low + b];
+                On[channel] = (0.0f != dB) && !((e_Tier_LeanEQ <= Ctl_Tier) && (fabsf(dB) < 1.0f));
+                Steady = Steady && (Band_Mix[channel][b] == (On[channel] ? 1.0f : 0.0f));
+            }
+
+            //R1.01 Both channels on and not fading, filter them together.
+            if (Steady && (Channels == 2) && On[0] && On[1])
+            {
+                Kernels->BiQuad2(Data, Samples, Band[b]);
+                continue;
+            }
+
+            for (int channel = 0; channel < Channels; channel++)
+            {
+                float Target = On[channel] ? 1.0f : 0.0f;
+                float Mix = Band_Mix[channel][b];
+
+                if (Mix == Target)
+                {
+                    if (On[channel]) Kernels->BiQuad(Data[channel], Samples, Band[b], channel);
+                    continue;
+                }
+
+                //R1.01 A band coming back on starts from silence, it is faded in anyway.
+                //R1.01 In mono the right channel is cleared too, it carries on from the left when mono ends.
+                if (On[channel] && (Mix <= 0.0f))
+                    for (int c = channel; c < ((Channels < 2) ? 2 : channel + 1); c++)
+                        Band[b]->xn0[c] = Band[b]->xn1[c] = Band[b]->xn2[c] = Band[b]->yn1[c] = Band[b]->yn2[c] = 0.0f;
+
+                auto* cD = Data[channel];
+                for (int samp = 0; samp < Samples; samp++)
+                {
+                    float F = Filter_Calc_BiQuad(cD[samp], channel, Band[b]);
+                    cD[samp] += (F - cD[samp]) * Mix;
+                    Mix = On[channel] ? std::min(1.0f, Mix + Step) : std::max(0.0f, Mix - Step);
+                }
+                Band_Mix[channel][b] = Mix;
+            }
+        }
+    }
+
+    //R1.00 Apply some gain/drive/distortion.
+    //R1.00 Volume/Gain adjust.
+    float Target = (e_Tier_FastDrive <= Ctl_Tier) ? 1.0f : 0.0f;
+    bool Fade = (Drive_Mix != Target);
+    bool Driven = false;
+    float Mix = Drive_Mix;
+
+    for (int channel = 0; channel < Channels; channel++)
+    {
+        const float* Set = Setting[channel];
+        float Gain = Set[e_Gain] * Set[e_Gain] * 10.0f;
+        float Drive = (.1f + Set[e_Drive]) * 6.0f;
+        auto* cD = Data[channel];
+
+        //R1.01 No drive, nothing to fade.
+        if (Set[e_Drive] <= 0.0f)
+        {
+            Kernels->Drive(cD, Samples, Gain, Drive, MakoKernels::e_Drive_Gain);
+            AA_State[channel].Primed = 0;
+            continue;
+        }
+        Driven = true;
+
+        //R1.01 DRIVE ANTI-ALIASING replaces both tanh curves.
+        if (AA_Order != e_DriveAA_Off)
+        {
+            Kernels->DriveAA(cD, Samples, Gain, Drive, AA_Order, &AA_State[channel]);
+            continue;
+        }
+
+        if (!Fade)
+        {
+            Kernels->Drive(cD, Samples, Gain, Drive, (0.0f < Target) ? MakoKernels::e_Drive_Fast : MakoKernels::e_Drive_Exact);
+            continue;
+        }
+
+        Mix = Drive_Mix;
+        for (int samp = 0; samp < Samples; samp++)
+        {
+            float Exact = tanhf(cD[samp] * Drive);
+            float Cheap = Mako_FastTanh(cD[samp] * Drive);
+            cD[samp] = Gain * (Exact + (Cheap - Exact) * Mix);
+            Mix = (Mix < Target) ? std::min(Target, Mix + Step) : std::max(Target, Mix - Step);
+        }
+    }
+    Drive_Mix = (Fade && Driven) ? Mix : Target;
+}
+
+//R1.01 DYNAMIC EQ. Runs the EQ bands while it is on, and for two control steps after it is turned off,
+//R1.01 with the ratio at 1 so the gains glide back to the knobs. Returns false when the static EQ runs.
+bool MakoEngine::Mako_Dyn_EQ(float* const* Data, int Channels, int Samples)
+{
+    tp_filter* Band[3] = { &Dsp.makoF_Low, &Dsp.makoF_Mid, &Dsp.makoF_High };
+
+    if (!Dyn_On && !Dyn_Active) return false;
+
+    //R1.01 Starting. Bands the static EQ had off have a stale state, and the detectors start from silence.
+    if (!Dyn_Active)
+    {
+        for (int channel = 0; channel < 2; channel++)
+            for (int b = 0; b < 3; b++)
+                if (Band_Mix[channel][b] <= 0.0f)
+                    Band[b]->xn0[channel] = Band[b]->xn1[channel] = Band[b]->xn2[channel] = Band[b]->yn1[channel] = Band[b]->yn2[channel] = 0.0f;
+        Dyn_State = {};
+        Dyn_Active = true;
+    }
+
+    if (Dyn_On)
+    {
+        Kernels->DynEQ(Data, Channels, Samples, Band, Dyn, &Dyn_State);
+        Dyn_Exit = 2 * MakoKernels::Dyn_Step;
+    }
+    else
+    {
+        MakoKernels::tp_dynset Off = Dyn;
+        for (auto& Slope : Off.Slope) Slope = 0.0f;
+        Kernels->DynEQ(Data, Channels, Samples, Band, Off, &Dyn_State);
+
+        //R1.01 Back on the knobs, the static EQ takes over with its own coefficients.
+        Dyn_Exit -= Samples;
+        if (Dyn_Exit <= 0)
+        {
+            Dyn_Active = false;
+            for (int channel = 0; channel < 2; channel++)
+                for (int b = 0; b < 3; b++) Filter_Set_Coeffs(EQ_Static[channel][b], Band[b], channel);
+        }
+    }
+
+    //R1.01 Every band has been running. The static EQ fades out the ones it has off.
+    for (int channel = 0; channel < 2; channel++)
+        for (int b = 0; b < 3; b++) Band_Mix[channel][b] = 1.0f;
+    return true;
+}
+
+//R1.01 COMPRESSOR stage. A threshold of 1.0 turns it off.
+//R1.01 Reads the peak envelope of its own input: from its own detector if a stage that changes the
+//R1.01 level sits between the shared detector and us, else from the shared detector.
+void MakoEngine::Mako_Stage_Comp(float* const* Data, int Channels, int Samples)
+{
+    int Mask = 0;
+    for (int channel = 0; channel < Channels; channel++)
+        if (Setting[channel][e_Comp1] < 1.0f) Mask |= 1 << channel;
+    if (Mask == 0) return;
+
+    MakoKernels::tp_comp Comp[2] = { Mako_Comp_Settings(0), Mako_Comp_Settings(1) };
+
+    //R1.01 Multiband mode does its own level detection per band. Both channels run together,
+    //R1.01 each lane with its own channel's settings.
+    if (1 < MB.Bands)
+    {
+        Kernels->MultiBand(Data, Mask, Samples, MB.F, MB.Env, MB.GainAdj, Comp);
+        return;
+    }
+
+    for (int channel = 0; channel < Channels; channel++)
+    {
+        if ((Mask & (1 << channel)) == 0) continue;
+        const float* Env = Comp_OwnDet ? Comp_Peak[channel] : Env_Peak[channel];
+        Kernels->Comp(Data[channel], Env, Samples, Comp[channel], &Dsp.Pedal_CompGain[channel], &Dsp.Pedal_CompGainAdj[channel]);
+    }
+}
+
+//R1.01 Compressor settings of a channel for the kernels. The attack and release times are fixed.
+MakoKernels::tp_comp MakoEngine::Mako_Comp_Settings(int Channel) const
+{
+    MakoKernels::tp_comp C;
+    C.Thresh = Setting[Channel][e_Comp1];   //R1.00 Compressor Threshold.
+    C.Ratio = Setting[Channel][e_Comp2];    //R1.00 Compressor RATIO.
+    C.Attack = Release_5mS;
+    C.Release = Release_50mS;
+    C.PeakDecay = Det_PeakDecay;
+    return C;
+}
+
+//R1.01 SHARED ENVELOPE DETECTOR stage. Computes the peak and RMS envelopes once per chunk.
+//R1.01 Peak: instant attack with an adjustable release. RMS: one pole average of the squared signal.
+//R1.01 The abs and square passes are vectorized, only the one pole smoothing runs sample by sample.
+//R1.01 Also feeds the INPUT meters, so there is no separate metering pass.
+void MakoEngine::Mako_Stage_Detect(float* const* Data, int Channels, int Samples)
+{
+    if (!Det_Active) return;
+
+    for (int channel = 0; channel < Channels; channel++)
+    {
+        float Max = Kernels->Detect(Data[channel], Env_Peak[channel], Env_RMS[channel], Samples, Det_PeakDecay, Det_RMSCoef, &Dsp.Det_Peak[channel], &Dsp.Det_MS[channel]);
+
+        //R1.00 Track our loudest INPUT signal.
+        if (Metering && (VUValue[channel] < Max)) VUValue[channel] = Max;
+    }
+}
+
+//R1.01 COMPRESSOR DETECTOR. Only in the list when the level changes between the shared detector and the
+//R1.01 compressor. Same peak detector, run on the compressor's input. Multiband does its own per band.
+void MakoEngine::Mako_Stage_CompDetect(float* const* Data, int Channels, int Samples)
+{
+    if (1 < MB.Bands) return;
+
+    alignas(64) float Rms[Block_Max];
+    for (int channel = 0; channel < Channels; channel++)
+    {
+        //R1.01 Off, so it starts from silence when the compressor comes back on.
+        if (1.0f <= Setting[channel][e_Comp1])
+        {
+            Dsp.CompDet_Peak[channel] = Dsp.CompDet_MS[channel] = 0.0f;
+            continue;
+        }
+        Kernels->Detect(Data[channel], Comp_Peak[channel], Rms, Samples, Det_PeakDecay, Det_RMSCoef, &Dsp.CompDet_Peak[channel], &Dsp.CompDet_MS[channel]);
+    }
+}
+
+//R1.01 CAB IR stage. Off until an IR is loaded. In mono the convolver keeps the right channel
+//R1.01 state following the left, so leaving mono carries on without a gap.
+void MakoEngine::Mako_Stage_Cab(float* const* Data, int Channels, int Samples)
+{
+    if (Cab_Live == nullptr) return;
+
+    Cab_Live->Process(Data[0], (1 < Channels) ? Data[1] : nullptr, Samples);
+}
+
+//R1.01 LIMITER stage. Off until the limiter parameter turns it on. A new lookahead from the coefficient
+//R1.01 thread restarts the limiter.
+void MakoEngine::Mako_Stage_Limit(float* const* Data, int Channels, int Samples)
+{
+    int Ahead = Limit_Ahead.load(std::memory_order_relaxed);
+    if (Ahead != Limiter.GetAhead()) Limiter.Prepare(Ahead, SampleRate);
+    if (Ahead <= 0) return;
+
+    Limiter.Process(Data, Channels, Samples);
+}
+
+//R1.01 Walk the stage graph and write a flat list of stage functions for the audio thread.
+//R1.01 Coeff_Lock held. The audio thread picks the new list up at its next block.
+void MakoEngine::Mako_Stage_Compile()
+{
+    static const tp_stagefunc StageFunc[e_Node_Count] = {
+        &MakoEngine::Mako_Stage_LowCut,
+        &MakoEngine::Mako_Stage_Gate,
+        &MakoEngine::Mako_Stage_EQGain,
+        &MakoEngine::Mako_Stage_Comp,
+        &MakoEngine::Mako_Stage_Detect,
+        &MakoEngine::Mako_Stage_Cab,
+        &MakoEngine::Mako_Stage_Limit,
+        &MakoEngine::Mako_Stage_CompDetect,
+    };
+    static const char* StageName[e_Node_Count] = { "LowCut", "Gate", "EQ/Gain/Drive", "Compressor", "Detector", "Cab IR", "Limiter", "Comp Detector" };
+
+    tp_stagelist& List = Stage_Dispatch.Writing();
+    bool Used[e_Stage_Count] = {};
+    bool DetDone = false;
+    bool LevelAfterDet = false;
+    int Stage = Stage_First;
+    int Order[e_Node_Count];
+    int Count = 0;
+
+    //R1.01 Stop at the end of the chain or if a bad link would make us loop forever.
+    //R1.01 The gate and compressor read the detector, so it is moved up in front of them if needed.
+    //R1.01 The compressor gets its own detector if the level can change after the shared one.
+    List.CompOwnDet = false;
+    while ((0 <= Stage) && (Stage < e_Stage_Count) && !Used[Stage])
+    {
+        Used[Stage] = true;
+        if ((Stage == e_Stage_Gate || Stage == e_Stage_Comp || Stage == e_Stage_Detect) && !DetDone)
+        {
+            Order[Count++] = e_Stage_Detect;
+            DetDone = true;
+        }
+        if ((Stage == e_Stage_LowCut || Stage == e_Stage_Gate || Stage == e_Stage_EQGain) && DetDone) LevelAfterDet = true;
+        if ((Stage == e_Stage_Comp) && LevelAfterDet)
+        {
+            Order[Count++] = e_Node_CompDetect;
+            List.CompOwnDet = true;
+        }
+        if (Stage != e_Stage_Detect) Order[Count++] = Stage;
+        Stage = Stage_Next[Stage];
+    }
+
+    //R1.01 The meters always need the detector, so it runs first if the graph left it out.
+    List.Count = 0;
+    if (!DetDone)
+    {
+        List.Stage[List.Count] = e_Stage_Detect;
+        List.Func[List.Count] = StageFunc[e_Stage_Detect];
+        List.Name[List.Count] = StageName[e_Stage_Detect];
+        List.Count++;
+    }
+
+    for (int t = 0; t < Count; t++)
+    {
+        List.Stage[List.Count] = Order[t];
+        List.Func[List.Count] = StageFunc[Order[t]];
+        List.Name[List.Count] = StageName[Order[t]];
+        List.Count++;
+    }
+
+    Stage_Dispatch.Publish();
+}
+
+//R1.01 The stage list has one writer, whoever holds Coeff_Lock.
+bool MakoEngine::Mako_Stage_SetOrder(const int* Order, int Count)
+{
+    std::lock_guard<std::mutex> Lock(Coeff_Lock);
+    return Mako_Stage_Link(Order, Count);
+}
+
+//R1.01 Rewire the graph so the stages run in the order given. Coeff_Lock held.
+bool MakoEngine::Mako_Stage_Link(const int* Order, int Count)
+{
+    bool Used[e_Stage_Count] = {};
+
+    //R1.01 Each stage may only be used once.
+    if ((Count < 1) || (e_Stage_Count < Count)) return false;
+    for (int t = 0; t < Count; t++)
+    {
+        if ((Order[t] < 0) || (e_Stage_Count <= Order[t]) || Used[Order[t]]) return false;
+        Used[Order[t]] = true;
+    }
+
+    Stage_First = Order[0];
+    for (int t = 0; t < Count; t++) Stage_Next[Order[t]] = (t + 1 < Count) ? Order[t + 1] : -1;
+
+    Mako_Stage_Compile();
+    return true;
+}
+
+//R1.01 Set one of our preset chain orders, with the detector placed as the detpos parameter says.
+//R1.01 The cab IR and the limiter always go last.
+void MakoEngine::Mako_Stage_SetChain(int Chain, int DetPos)
+{
+    static const int ChainOrder[e_Chain_Count][4] = {
+        { e_Stage_LowCut, e_Stage_Gate, e_Stage_EQGain, e_Stage_Comp },  //R1.01 Standard.
+        { e_Stage_LowCut, e_Stage_Gate, e_Stage_Comp, e_Stage_EQGain },  //R1.01 Compressor before drive.
+        { e_Stage_Gate, e_Stage_LowCut, e_Stage_EQGain, e_Stage_Comp },  //R1.01 Gate before low cut.
+    };
+    int Order[e_Stage_Count];
+    int Count = 0;
+
+    if ((Chain < 0) || (e_Chain_Count <= Chain)) Chain = e_Chain_Standard;
+
+    //R1.01 The compiler moves the detector up in front of the gate if the low cut comes later.
+    if (DetPos == e_DetPos_Input) Order[Count++] = e_Stage_Detect;
+    for (int t = 0; t < 4; t++)
+    {
+        Order[Count++] = ChainOrder[Chain][t];
+        if ((ChainOrder[Chain][t] == e_Stage_LowCut) && (DetPos != e_DetPos_Input)) Order[Count++] = e_Stage_Detect;
+    }
+    Order[Count++] = e_Stage_Cab;
+    Order[Count++] = e_Stage_Limit;
+
+    Mako_Stage_Link(Order, Count);
+}
+
+//R1.01 Flag settings for the coefficient thread. Only the first bit since the thread last looked posts
+//R1.01 a wake up, the rest ride along. Posting never locks, so this is safe from the audio thread during automation.
+void MakoEngine::Mako_Settings_Dirty(uint32_t Bits)
+{
+    if ((Settings_Dirty.fetch_or(Bits) == 0) && (Coeff_Crew != nullptr)) Coeff_Crew->Wake.Post();
+}
+
+//R1.01 Lookahead in samples for a limiter mode at our sample rate.
+int MakoEngine::Mako_Limit_Ahead(int Mode) const
+{
+    static const float Ahead_mS[e_Limit_Count] = { 0.0f, .5f, 1.5f, 3.0f, 5.0f };
+    Mode = std::min(std::max(Mode, 0), e_Limit_Count - 1);
+    if (Mode == e_Limit_Off) return 0;
+
+    return std::min(std::max(int(std::lround(Ahead_mS[Mode] * .001f * SampleRate)), 1), MakoLimiter::Ahead_Max);
+}
+
+int MakoEngine::GetLatency(int LimitMode) const
+{
+    if (LimitMode < 0) LimitMode = int(GetParam(e_Parm_Limiter));
+    return MakoLimiter::Latency(Mako_Limit_Ahead(LimitMode));
+}
+
+//R1.01 Hand a new convolver (or none) to the audio thread. The old one comes back to us and is deleted here.
+void MakoEngine::Mako_IR_Set(std::shared_ptr<const MakoIR> IR)
+{
+    Cab.Writing() = (IR != nullptr) ? std::make_unique<MakoConvolver>(IR) : nullptr;
+    Cab.Publish();
+    Cab.Writing().reset();
+    IR_Current = std::move(IR);
+}
+
+//R1.00 Apply filter to a sample.
+float MakoEngine::Filter_Calc_BiQuad(float tSample, int channel, tp_filter* fn)
+{
+    float tS = tSample;
+
+    fn->xn0[channel] = tS;
+    tS = fn->a0[channel] * fn->xn0[channel] + fn->a1[channel] * fn->xn1[channel] + fn->a2[channel] * fn->xn2[channel] - fn->b1[channel] * fn->yn1[channel] - fn->b2[channel] * fn->yn2[channel];
+    fn->xn2[channel] = fn->xn1[channel]; fn->xn1[channel] = fn->xn0[channel]; fn->yn2[channel] = fn->yn1[channel]; fn->yn1[channel] = tS;
+
+    return tS;
+}
+
+//R1.00 Second order parametric/peaking boost filter with constant-Q
+void MakoEngine::Filter_BP_Coeffs(float Gain_dB, float Fc, float Q, tp_coeffs* fn)
+{
+    float K = pi2 * (Fc * .5f) / SampleRate;
+    float K2 = K * K;
+    float V0 = pow(10.0, Gain_dB / 20.0);
+
+    float a = 1.0f + (V0 * K) / Q + K2;
+    float b = 2.0f * (K2 - 1.0f);
+    float g = 1.0f - (V0 * K) / Q + K2;
+    float d = 1.0f - K / Q + K2;
+    float dd = 1.0f / (1.0f + K / Q + K2);
+
+    fn->a0 = a * dd;
+    fn->a1 = b * dd;
+    fn->a2 = g * dd;
+    fn->b1 = b * dd;
+    fn->b2 = d * dd;
+}
+
+//R1.00 Second order butterworth LOW PASS filter.
+void MakoEngine::Filter_LP_Coeffs(float fc, tp_coeffs* fn)
+{
+    float c = 1.0f / (tanf(pi * fc / SampleRate));
+    fn->a0 = 1.0f / (1.0f + sqrt2 * c + (c * c));
+    fn->a1 = 2.0f * fn->a0;
+    fn->a2 = fn->a0;
+    fn->b1 = 2.0f * fn->a0 * (1.0f - (c * c));
+    fn->b2 = fn->a0 * (1.0f - sqrt2 * c + (c * c));
+}
+
+//R1.00 Second order butterworth HIGH PASS filter.
+void MakoEngine::Filter_HP_Coeffs(float fc, tp_coeffs* fn)
+{
+    float c = tanf(pi * fc / SampleRate);
+    fn->a0 = 1.0f / (1.0f + sqrt2 * c + (c * c));
+    fn->a1 = -2.0f * fn->a0;
+    fn->a2 = fn->a0;
+    fn->b1 = 2.0f * fn->a0 * ((c * c) - 1.0f);
+    fn->b2 = fn->a0 * (1.0f - sqrt2 * c + (c * c));
+}
+
+//R1.01 Copy a set of precalculated coefficients into one channel of a filter.
+void MakoEngine::Filter_Set_Coeffs(const tp_coeffs& Co, tp_filter* fn, int channel)
+{
+    fn->a0[channel] = Co.a0;
+    fn->a1[channel] = Co.a1;
+    fn->a2[channel] = Co.a2;
+    fn->b1[channel] = Co.b1;
+    fn->b2[channel] = Co.b2;
+}
+
+//R1.01 Find (or build) the shared coefficient table for our sample rate.
+//R1.01 Called from Prepare, never the audio thread. Tables are only added, never changed or removed,
+//R1.01 and live until the process ends (about 10 KB per sample rate).
+const MakoEngine::tp_coefftable* MakoEngine::Mako_Tables_Get()
+{
+    static const float EQ_Freq[3] = { 450.0f, 750.0f, 1500.0f };
+    static std::mutex Shared_Lock;
+    static std::vector<std::unique_ptr<tp_coefftable>> Shared_Tables;
+    MAKO_AUDIT_LOCK("Mako_Tables_Get");
+    std::lock_guard<std::mutex> Lock(Shared_Lock);
+
+    for (auto& Table : Shared_Tables)
+        if (Table->SampleRate == SampleRate) return Table.get();
+
+    //R1.01 First instance at this sample rate, fill a new table using our normal filter code.
+    auto Table = std::make_unique<tp_coefftable>();
+    Table->SampleRate = SampleRate;
+
+    for (int t = 0; t < 181; t++) Filter_HP_Coeffs(float(20 + t), &Table->LowCut[t]);
+
+    for (int b = 0; b < 3; b++)
+        for (int t = 0; t < 241; t++) Filter_BP_Coeffs(-12.0f + t * .1f, EQ_Freq[b], .707f, &Table->EQ[b][t]);
+
+    Shared_Tables.push_back(std::move(Table));
+    return Shared_Tables.back().get();
+}
+
+//R1.01 Set the coefficients for one lane (band) of one multiband filter stage.
+void MakoEngine::Mako_MB_SetLane(tp_multiband& Out, int Stage, int Lane, float a0, float a1, float a2, float b1, float b2)
+{
+    tp_lanefilter& F = Out.F[Stage];
+    F.a0[Lane] = a0;
+    F.a1[Lane] = a1;
+    F.a2[Lane] = a2;
+    F.b1[Lane] = b1;
+    F.b2[Lane] = b2;
+}
+
+//R1.01 Build the band filter cascades for 2, 3 or 4 bands.
+//R1.01 Band k = HP4 of every lower crossover, LP4 of its own crossover, and an allpass for every higher one.
+//R1.01 The LR4 allpass (LP4 + HP4) is the same as a 2nd order allpass using the Butterworth denominator,
+//R1.01 so the bands add back to a flat magnitude: AP(f1) * AP(f2) * AP(f3).
+//R1.01 Out gets a clear filter and gain state, ready to be swapped in whole.
+void MakoEngine::Mako_MB_Design(int Bands, tp_multiband& Out)
+{
+    static const float Xover[5][3] = { {}, {}, { 700.0f }, { 250.0f, 1500.0f }, { 200.0f, 800.0f, 2500.0f } };
+    tp_coeffs F = {};
+
+    Bands = std::min(std::max(Bands, 1), 4);
+    Out = {};
+    Out.Bands = Bands;
+    if (Bands < 2) return;
+
+    for (int k = 0; k < 4; k++)
+    {
+        int Stage = 0;
+
+        //R1.01 Unused lanes output silence.
+        if (Bands <= k)
+        {
+            for (int f = 0; f < MB_Stages; f++) Mako_MB_SetLane(Out, f, k, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+            continue;
+        }
+
+        for (int j = 0; j < Bands - 1; j++)
+        {
+            if (j < k)
+            {
+                Filter_HP_Coeffs(Xover[Bands][j], &F);
+                Mako_MB_SetLane(Out, Stage++, k, F.a0, F.a1, F.a2, F.b1, F.b2);
+                Mako_MB_SetLane(Out, Stage++, k, F.a0, F.a1, F.a2, F.b1, F.b2);
+            }
+            else if (j == k)
+            {
+                Filter_LP_Coeffs(Xover[Bands][j], &F);
+                Mako_MB_SetLane(Out, Stage++, k, F.a0, F.a1, F.a2, F.b1, F.b2);
+                Mako_MB_SetLane(Out, Stage++, k, F.a0, F.a1, F.a2, F.b1, F.b2);
+            }
+            else
+            {
+                Filter_LP_Coeffs(Xover[Bands][j], &F);
+                Mako_MB_SetLane(Out, Stage++, k, F.b2, F.b1, 1.0f, F.b1, F.b2);
+            }
+        }
+
+        //R1.01 Pad the rest of the cascade with pass thru filters.
+        while (Stage < MB_Stages) Mako_MB_SetLane(Out, Stage++, k, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+    }
+
+    for (int ch = 0; ch < 2; ch++)
+        for (int k = 0; k < 4; k++) Out.GainAdj[ch][k] = 1.0f;
+}
+
+//R1.01 Work out the coefficients for the settings flagged in Bits and publish the whole set.
+//R1.01 Runs on the coefficient thread (or in Prepare/constructor), never on the audio thread.
+//R1.01 Coeff_Lock is always held, except in the constructor before the thread exists.
+void MakoEngine::Mako_Coeffs_Compute(uint32_t Bits)
+{
+    MAKO_TRACE_SCOPE("Mako_Coeffs_Compute");
+    static const float EQ_Freq[3] = { 450.0f, 750.0f, 1500.0f };
+    tp_coeffset& W = Coeff_Work;
+
+    //R1.00 Update our EQ Filters.
+    //R1.01 In HIGH DENSITY mode use the shared tables, no pow or tan calls needed.
+    //R1.01 Switching modes changes where every filter gets its coefficients from, so all are redone.
+    bool Table = (.5f <= GetParam(e_Parm_Density)) && (CoeffTable != nullptr);
+    bool All = (Bits & (1u << e_Dirty_Density)) != 0;
+
+    //R1.01 DUAL MONO. The right channel has its own knobs, otherwise it is a copy of the left.
+    bool Dual = (.5f <= GetParam(e_Parm_Dual));
+
+    for (int ch = 0; ch < 2; ch++)
+    {
+        if ((ch == 1) && !Dual)
+        {
+            memcpy(W.Setting[1], W.Setting[0], sizeof(W.Setting[0]));
+            W.LowCut[1] = W.LowCut[0];
+            for (int b = 0; b < 3; b++) W.EQ[1][b] = W.EQ[0][b];
+            break;
+        }
+
+        //R1.01 Which settings of this channel changed. The right channel is redone whole.
+        uint32_t Mine = Bits;
+        if (ch == 1) Mine = (All || ((Bits & (1u << e_Dirty_Right)) != 0)) ? Dirty_All : 0;
+        int Base = (ch == 0) ? 0 : int(e_Parm_Right);
+
+        for (int t = 0; t < e_Setting_Count; t++)
+            if ((Mine & (1u << t)) != 0) W.Setting[ch][t] = GetParam(Base + t);
+
+        if (All || ((Mine & (1u << e_LowCut)) != 0))
+        {
+            if (Table)
+                W.LowCut[ch] = CoeffTable->LowCut[std::min(std::max(int(std::lround(W.Setting[ch][e_LowCut])) - 20, 0), 180)];
+            else
+                Filter_HP_Coeffs(W.Setting[ch][e_LowCut], &W.LowCut[ch]);
+        }
+
+        for (int b = 0; b < 3; b++)
+        {
+            if (!All && ((Mine & (1u << (e_Low + b))) == 0)) continue;
+
+            if (Table)
+                W.EQ[ch][b] = CoeffTable->EQ[b][std::min(std::max(int(std::lround((W.Setting[ch][e_Low + b] + 12.0f) * 10.0f)), 0), 240)];
+            else
+                Filter_BP_Coeffs(W.Setting[ch][e_Low + b], EQ_Freq[b], .707f, &W.EQ[ch][b]);
+        }
+    }
+    W.Linked = (memcmp(W.Setting[0], W.Setting[1], sizeof(W.Setting[0])) == 0);
+
+    //R1.01 DYNAMIC EQ. The knob gains every time, the detectors and curves when they changed (or the sample rate).
+    W.DynEQ = (.5f <= GetParam(e_Parm_DynEQ));
+    for (int ch = 0; ch < 2; ch++)
+        for (int b = 0; b < 3; b++) W.Dyn.Static[ch][b] = W.Setting[ch][e_Low + b];
+
+    if ((Bits & (1u << e_Dirty_Dyn)) != 0)
+    {
+        for (int b = 0; b < 3; b++)
+        {
+            //R1.01 Band pass detector, 0 dB at the band frequency.
+            float w0 = pi2 * EQ_Freq[b] / SampleRate;
+            float Alpha = sinf(w0) * .5f;
+            float Norm = 1.0f / (1.0f + Alpha);
+            W.Dyn.d_a0[b] = Alpha * Norm;
+            W.Dyn.d_b1[b] = -2.0f * cosf(w0) * Norm;
+            W.Dyn.d_b2[b] = (1.0f - Alpha) * Norm;
+
+            float Attack = std::max(GetParam(e_Parm_DynAttack + b), .1f);
+            float Release = std::max(GetParam(e_Parm_DynRelease + b), 1.0f);
+            W.Dyn.Attack[b] = 1.0f - expf(-1000.0f / (Attack * SampleRate));
+            W.Dyn.Release[b] = 1.0f - expf(-1000.0f / (Release * SampleRate));
+            W.Dyn.Thresh[b] = GetParam(e_Parm_DynThresh + b);
+            W.Dyn.Slope[b] = 1.0f - 1.0f / std::max(GetParam(e_Parm_DynRatio + b), 1.0f);
+
+            //R1.01 The same peaking filter as Filter_BP_Coeffs, split into the parts that do and do not move with the gain.
+            float K = pi2 * (EQ_Freq[b] * .5f) / SampleRate;
+            float Q = .707f;
+            float dd = 1.0f / (1.0f + K / Q + K * K);
+            W.Dyn.C0[b] = (1.0f + K * K) * dd;
+            W.Dyn.C1[b] = (K / Q) * dd;
+        }
+    }
+
+    //R1.01 Shared detector time constants.
+    if ((Bits & (1u << e_Dirty_Detector)) != 0)
+    {
+        float PeakTime = std::max(GetParam(e_Parm_DetPeak), .1f);
+        float RMSTime = std::max(GetParam(e_Parm_DetRMS), .1f);
+        W.Det_PeakDecay = expf(-1000.0f / (PeakTime * SampleRate));
+        W.Det_RMSCoef = 1.0f - expf(-1000.0f / (RMSTime * SampleRate));
+    }
+
+    //R1.01 Multiband compressor crossovers. Only redesigned when the band count changes (or sample rate).
+    if ((Bits & (1u << e_Dirty_Bands)) != 0)
+    {
+        int Bands = 1 + int(GetParam(e_Parm_CompBands));
+        if ((Bands != W.MB.Bands) || (SampleRate != W.MB_Rate))
+        {
+            Mako_MB_Design(Bands, W.MB);
+            W.MB_Rate = SampleRate;
+            W.MB_Serial++;
+        }
+    }
+
+    Coeffs.Writing() = W;
+    Coeffs.Publish();
+
+    //R1.01 Stage order. We hold Coeff_Lock, so we are the only writer of the stage list.
+    if ((Bits & (1u << e_Dirty_Chain)) != 0) Mako_Stage_SetChain(int(GetParam(e_Parm_Chain)), int(GetParam(e_Parm_DetPos)));
+
+    //R1.01 Limiter lookahead. A host reporting latency has already reported the new one (see GetLatency).
+    if ((Bits & (1u << e_Dirty_Limit)) != 0) Limit_Ahead.store(Mako_Limit_Ahead(int(GetParam(e_Parm_Limiter))));
+}
+
+//R1.01 Audio thread. Copy a finished coefficient set in. The filter states carry on, the multiband
+//R1.01 state only starts over when its crossovers were redesigned.
+void MakoEngine::Mako_Coeffs_Apply(const tp_coeffset& Set)
+{
+    tp_filter* Band[3] = { &Dsp.makoF_Low, &Dsp.makoF_Mid, &Dsp.makoF_High };
+
+    memcpy(Setting, Set.Setting, sizeof(Setting));
+    Linked = Set.Linked;
+    for (int channel = 0; channel < 2; channel++)
+    {
+        Filter_Set_Coeffs(Set.LowCut[channel], &Dsp.makoF_LowCut, channel);
+
+        //R1.01 While the dynamic EQ runs a0 and a2 are its own, it glides to new knob gains by itself.
+        for (int b = 0; b < 3; b++)
+        {
+            float a0 = Band[b]->a0[channel];
+            float a2 = Band[b]->a2[channel];
+            EQ_Static[channel][b] = Set.EQ[channel][b];
+            Filter_Set_Coeffs(Set.EQ[channel][b], Band[b], channel);
+            if (Dyn_Active)
+            {
+                Band[b]->a0[channel] = a0;
+                Band[b]->a2[channel] = a2;
+            }
+        }
+    }
+    Dyn = Set.Dyn;
+    Dyn_On = Set.DynEQ;
+    Det_PeakDecay = Set.Det_PeakDecay;
+    Det_RMSCoef = Set.Det_RMSCoef;
+
+    if (Set.MB_Serial != MB_Serial)
+    {
+        MB = Set.MB;
+        MB_Serial = Set.MB_Serial;
+    }
+}
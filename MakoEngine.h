@@ -0,0 +1,471 @@
+/*
+  ==============================================================================
+
+    MakoEngine.h
+    R1.01 The whole MakoPrecog DSP chain behind a small API, for hosts of our own.
+
+    The plugin is a thin adapter over this class: it maps its parameters onto
+    ours, reports the latency and loads IR files. Anything else can run the
+    same sound with:
+
+        MakoEngine Engine;
+        MakoEngine::tp_params P;
+        P.Drive = .5f;
+        Engine.SetParams(P);
+        Engine.Prepare(48000.0, 512);
+        Engine.Process(Channels, Samples);      //R1.01 In place, every block.
+
+    Parameters are plain numbers in a flat array, set by index. There are no
+    strings and no virtual calls anywhere on the audio path.
+
+    Threads:
+    * Process  - the audio thread. Never allocates, locks or waits.
+    * SetParam - any thread, even the audio thread. Only flags what changed.
+    * Prepare, Mako_IR_Set, Mako_Stage_SetOrder - one control thread, while
+      Process is not running for Prepare.
+
+    Plain C++, no JUCE needed.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "MakoConvolver.h"     //R1.01 Cabinet IR convolution.
+#include "MakoTruePeak.h"      //R1.01 True peak output metering.
+#include "MakoLimiter.h"       //R1.01 Lookahead output limiter.
+#include "MakoKernels.h"       //R1.01 DSP kernels for each instruction set.
+
+class MakoEngine
+{
+public:
+    MakoEngine();
+    ~MakoEngine();
+
+    //R1.00 These are the indexes into our Settings var.
+    enum { e_Gain, e_LowCut, e_NGate, e_Drive, e_Comp1, e_Comp2, e_Low, e_Mid, e_High, e_Setting_Count };
+
+    //R1.01 PARAMETERS, by index. The knob settings come first, in Setting[] order.
+    //R1.01 Values are the same as the plugin parameters: choices are their index, switches 0 or 1.
+    //R1.01 The DYNAMIC EQ settings are one per EQ band, e_Parm_DynThresh + band (0 Low, 1 Mid, 2 High) and so on.
+    //R1.01 The right channel knobs are last, e_Parm_Right + a setting index. They are only used in DUAL MONO.
+    enum {
+        e_Parm_Chain = e_Setting_Count, e_Parm_DetPos, e_Parm_DetPeak, e_Parm_DetRMS, e_Parm_Mono,
+        e_Parm_CompBands, e_Parm_Limiter, e_Parm_Bypass, e_Parm_Quality, e_Parm_Density, e_Parm_Dual,
+        e_Parm_DynEQ, e_Parm_DynThresh, e_Parm_DynRatio = e_Parm_DynThresh + 3, e_Parm_DynAttack = e_Parm_DynRatio + 3,
+        e_Parm_DynRelease = e_Parm_DynAttack + 3, e_Parm_DriveAA = e_Parm_DynRelease + 3, e_Parm_Right,
+        e_Parm_Count = e_Parm_Right + e_Setting_Count
+    };
+
+    //R1.01 Our processing STAGES. Each one runs over a whole block of samples.
+    enum { e_Stage_LowCut, e_Stage_Gate, e_Stage_EQGain, e_Stage_Comp, e_Stage_Detect, e_Stage_Cab, e_Stage_Limit, e_Stage_Count };
+
+    //R1.01 MONO modes. Auto runs mono while both inputs are exactly the same.
+    enum { e_Mono_Off, e_Mono_On, e_Mono_Auto, e_Mono_Count };
+
+    //R1.01 Where the shared envelope DETECTOR sits in the chain.
+    enum { e_DetPos_Input, e_DetPos_LowCut, e_DetPos_Count };
+
+    //R1.01 Preset stage orders selectable with the chain parameter.
+    enum { e_Chain_Standard, e_Chain_CompFirst, e_Chain_GateFirst, e_Chain_Count };
+
+    //R1.01 ADAPTIVE QUALITY modes (CPU budget) and the tiers we step thru when over budget.
+    enum { e_Quality_Full, e_Quality_10, e_Quality_25, e_Quality_50, e_Quality_Count };
+    enum { e_Tier_Full, e_Tier_FastDrive, e_Tier_LeanEQ, e_Tier_Count };
+
+    //R1.01 DRIVE ANTI-ALIASING choices, the order of the ADAA drive.
+    enum { e_DriveAA_Off, e_DriveAA_1, e_DriveAA_2, e_DriveAA_Count };
+
+    //R1.01 LIMITER lookahead choices. Off keeps the old hard clip.
+    enum { e_Limit_Off, e_Limit_05, e_Limit_15, e_Limit_30, e_Limit_50, e_Limit_Count };
+
+    //R1.01 All parameters as one plain struct, with the plugin defaults.
+    struct tp_params {
+        float Gain = .3162278f;         //R1.01 0 - 1.
+        float LowCut = 20.0f;           //R1.01 20 - 200 Hz, 20 is off.
+        float NGate = 0.0f;             //R1.01 0 - 1, 0 is off.
+        float Drive = 0.0f;             //R1.01 0 - 1.
+        float Comp_Thresh = 1.0f;       //R1.01 0 - 1, 1 is off.
+        float Comp_Ratio = 1.0f;        //R1.01 0 - 1.
+        float Low = 0.0f;               //R1.01 EQ bands, -12 to +12 dB.
+        float Mid = 0.0f;
+        float High = 0.0f;
+        int Chain = e_Chain_Standard;
+        int DetPos = e_DetPos_LowCut;
+        float DetPeak_mS = 10.0f;       //R1.01 Detector peak release, 1 - 200 mS.
+        float DetRMS_mS = 4.0f;         //R1.01 Detector RMS time, 1 - 50 mS.
+        int Mono = e_Mono_Auto;
+        int CompBands = 1;              //R1.01 1 - 4.
+        int Limiter = e_Limit_Off;
+        bool Bypass = false;
+        int Quality = e_Quality_Full;
+        bool Density = false;
+        bool DynEQ = false;             //R1.01 DYNAMIC EQ. Per band Low, Mid, High:
+        float Dyn_Thresh[3] = { -30.0f, -30.0f, -30.0f };      //R1.01 -60 - 0 dB, band level.
+        float Dyn_Ratio[3] = { 3.0f, 3.0f, 3.0f };             //R1.01 1 - 10.
+        float Dyn_Attack_mS[3] = { 2.0f, 2.0f, 2.0f };         //R1.01 .1 - 50 mS.
+        float Dyn_Release_mS[3] = { 80.0f, 80.0f, 80.0f };     //R1.01 10 - 500 mS.
+        int DriveAA = e_DriveAA_Off;
+        bool Dual = false;              //R1.01 DUAL MONO, the right channel uses the knobs below.
+        float Right[e_Setting_Count] = { .3162278f, 20.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f };     //R1.01 In Setting order.
+    };
+
+    //R1.01 Set one parameter or all of them. Any thread, never waits. Coefficients are worked out on our
+    //R1.01 own thread and the audio thread picks them up at its next block.
+    void SetParam(int Id, float Value);
+    float GetParam(int Id) const { return ((0 <= Id) && (Id < e_Parm_Count)) ? Parm[Id].load(std::memory_order_relaxed) : 0.0f; }
+    void SetParams(const tp_params& P);
+    tp_params GetParams() const;
+
+    //R1.01 Get ready to run at this sample rate. MaxBlock is the biggest block Process will get,
+    //R1.01 Channels is 1 or 2. Control thread, while Process is not running.
+    void Prepare(double SampleRate, int MaxBlock, int Channels = 2);
+
+    //R1.01 Process a block in place. Data has the Channels given to Prepare. Audio thread.
+    void Process(float* const* Data, int Samples);
+
+    //R1.01 Latency in samples for a limiter mode at our sample rate, -1 is the current mode.
+    //R1.01 A host with a latency to report should report the new one before it changes the limiter parameter.
+    int GetLatency(int LimitMode = -1) const;
+    double GetSampleRate() const { return double(SampleRate); }
+
+    //R1.01 Rewire the stage graph in the order given. Control thread.
+    //R1.01 Stages left out of the order are not processed. The next chain change puts a preset order back.
+    bool Mako_Stage_SetOrder(const int* Order, int Count);
+
+    //R1.01 CAB IR. Hand a prepared IR (built for our sample rate) to the cab stage, nullptr turns it off.
+    //R1.01 Control thread, this allocates. Mako_IR_Get is the IR last set, for the same thread.
+    void Mako_IR_Set(std::shared_ptr<const MakoIR> IR);
+    const MakoIR* Mako_IR_Get() const { return IR_Current.get(); }
+
+    //R1.01 BYPASS by the host, as well as our bypass parameter. Audio thread only.
+    bool Host_Bypass = false;
+
+    //R1.01 METER EVENTS. Once per meter frame (1/60 second) the audio thread compares the frame with what was
+    //R1.01 last shown. Only a change the user could see (1% of a bar, .5 dB of gain reduction, an over or
+    //R1.01 a new quality tier) sets Meter_Dirty, and only while someone is watching. The audio thread never
+    //R1.01 calls out, the watcher clears the flag with exchange(false) and reads the meters when it was set.
+    //R1.01 0=Input L, 1=Input R, 2=Output L, 3=Output R
+    std::atomic<float> Meter_Level[4] = {};
+    std::atomic<float> Meter_GR{ 0.0f };    //R1.01 Gain reduction in dB, 0 or below.
+    std::atomic<int> Meter_Clip{ 0 };       //R1.01 One bit per output that went over in the last frame.
+    std::atomic<bool> Meter_Watched{ false };
+    std::atomic<bool> Meter_Dirty{ false };
+
+    //R1.01 Tier the adaptive quality is running at now.
+    std::atomic<int> Quality_Tier{ e_Tier_Full };
+
+    //R1.01 DSP KERNELS. Prepare picks the best instruction set this CPU has, unless a path is forced here
+    //R1.01 (or with the MAKO_KERNELS environment variable). A forced path starts at the next Prepare.
+    std::atomic<int> Kernel_Force{ MakoKernels::e_Path_Auto };
+    const char* Mako_Kernels_Name() const { return Kernels->Name; }
+
+private:
+    MakoEngine(const MakoEngine&) = delete;
+    MakoEngine& operator=(const MakoEngine&) = delete;
+
+    //R1.01 The parameters, set by anyone and read by the coefficient and audio threads.
+    std::atomic<float> Parm[e_Parm_Count];
+
+    //R1.01 Settings variables, [channel][setting]. The audio thread's copy, it comes with each coefficient set.
+    //R1.01 Unless in DUAL MONO the right channel is a copy of the left. Linked is set while both are the same,
+    //R1.01 only then can the mono fast path run.
+    float Setting[2][e_Setting_Count] = {};
+    bool Linked = true;
+
+    //R1.01 DIRTY bits, one per setting plus the ones below. Only what is flagged is worked out again.
+    //R1.01 Any right channel knob or the dual switch sets e_Dirty_Right, which redoes the whole right channel.
+    enum { e_Dirty_Detector = e_Setting_Count, e_Dirty_Bands, e_Dirty_Density, e_Dirty_Chain, e_Dirty_Limit, e_Dirty_Right, e_Dirty_Dyn, e_Dirty_Count };
+    static const uint32_t Dirty_All = (1u << e_Dirty_Count) - 1;
+    void Mako_Settings_Dirty(uint32_t Bits);
+
+    //R1.00 Our signal level values.
+    //R1.01 Loudest value in the current meter frame. Audio thread only.
+    float VUValue[4] = {};
+
+    //R1.01 Lock free hand off of a block of data from one writer thread to the audio thread.
+    //R1.01 Three slots: the writer fills its own slot and swaps it into the middle,
+    //R1.01 the audio thread swaps the middle out when the NEW bit is set. Nobody ever waits.
+    template <typename T> struct tp_handoff {
+        T Slot[3] = {};
+        int Write = 0;                  //R1.01 Writer thread only.
+        int Read = 1;                   //R1.01 Audio thread only.
+        std::atomic<int> Middle{ 2 };
+
+        T& Writing() { return Slot[Write]; }
+        void Publish() { Write = Middle.exchange(Write | 4, std::memory_order_acq_rel) & 3; }
+        bool Fetch()
+        {
+            if ((Middle.load(std::memory_order_relaxed) & 4) == 0) return false;
+            Read = Middle.exchange(Read, std::memory_order_acq_rel) & 3;
+            return true;
+        }
+        const T& Reading() const { return Slot[Read]; }
+    };
+
+    //R1.01 Every stage works on all channels of a block at once.
+    typedef void (MakoEngine::*tp_stagefunc)(float* const* Data, int Channels, int Samples);
+
+    //R1.01 The flat dispatch list the audio thread walks each block.
+    //R1.01 If a stage that changes the level (low cut, gate, EQ/gain) sits between the shared detector and the
+    //R1.01 compressor, the compiler puts the compressor's own detector (e_Node_CompDetect) just in front of it
+    //R1.01 and sets CompOwnDet. Only when nothing sits between them does the compressor read the shared envelope.
+    enum { e_Node_CompDetect = e_Stage_Count, e_Node_Count };
+    struct tp_stagelist {
+        int Count;
+        int Stage[e_Node_Count];
+        tp_stagefunc Func[e_Node_Count];
+        const char* Name[e_Node_Count];
+        bool CompOwnDet;
+    };
+
+    //R1.01 The stage graph. Each stage points at the stage that follows it, -1 ends the chain.
+    //R1.01 Only changed with Coeff_Lock held, the coefficient thread rebuilds it when the chain changes.
+    int Stage_First = e_Stage_LowCut;
+    int Stage_Next[e_Stage_Count] = { e_Stage_Detect, e_Stage_EQGain, e_Stage_Comp, e_Stage_Cab, e_Stage_Gate, e_Stage_Limit, -1 };
+    tp_handoff<tp_stagelist> Stage_Dispatch;
+    void Mako_Stage_Compile();
+    bool Mako_Stage_Link(const int* Order, int Count);
+    void Mako_Stage_SetChain(int Chain, int DetPos);
+
+    //R1.01 Our block STAGE functions.
+    void Mako_Stage_LowCut(float* const* Data, int Channels, int Samples);
+    void Mako_Stage_Gate(float* const* Data, int Channels, int Samples);
+    void Mako_Stage_EQGain(float* const* Data, int Channels, int Samples);
+    void Mako_Stage_Comp(float* const* Data, int Channels, int Samples);
+    void Mako_Stage_Detect(float* const* Data, int Channels, int Samples);
+    void Mako_Stage_CompDetect(float* const* Data, int Channels, int Samples);
+    void Mako_Stage_Cab(float* const* Data, int Channels, int Samples);
+    void Mako_Stage_Limit(float* const* Data, int Channels, int Samples);
+
+    //R1.01 Stages work on chunks of at most this many samples, so our work buffers are fixed size.
+    static constexpr int Block_Max = 256;
+
+    //R1.01 SHARED ENVELOPE DETECTOR output for the current chunk. Read by the gate, compressor and meters.
+    alignas(64) float Env_Peak[2][Block_Max] = {};
+    alignas(64) float Env_RMS[2][Block_Max] = {};
+    bool Det_Active = false;
+
+    //R1.01 COMPRESSOR DETECTOR output, peak envelope of the compressor's own input (CompOwnDet).
+    alignas(64) float Comp_Peak[2][Block_Max] = {};
+    bool Comp_OwnDet = false;
+    bool Metering = true;
+    MakoTruePeak TruePeak;
+    int Meter_Count = 0;
+    int Meter_Shown[4] = {};
+    int Meter_GR_Shown = 0;
+    int Meter_Tier_Shown = 0;
+    void Mako_Meter_Frame(int Samples);
+    float Det_PeakDecay = .998f;
+    float Det_RMSCoef = .005f;
+
+    //R1.01 Channels given to Prepare, and whether we run the left channel only right now.
+    //R1.01 Mono_Mix fades the right output over to the left when going mono (0 its own, 1 a copy of the left).
+    //R1.01 Mono_Same counts identical input samples in a row for auto mono, which needs Mono_Hold of them.
+    int Channel_Count = 2;
+    bool Mono_Active = false;
+    float Mono_Mix = 0.0f;
+    int Mono_Same = 0;
+    int Mono_Hold = 1;
+
+    //R1.01 MULTIBAND COMPRESSOR. Linkwitz-Riley (LR4) crossovers made from our Butterworth LP/HP filters.
+    //R1.01 Every band is built as its own cascade of up to six biquads running from the same input:
+    //R1.01 the LR4 split for the band, plus allpasses matching the higher crossovers so the bands sum flat.
+    //R1.01 One band per lane, so all bands are filtered and compressed together, four at a time.
+    static constexpr int MB_Stages = MakoKernels::MB_Stages;
+    typedef MakoKernels::tp_lanefilter tp_lanefilter;
+
+    struct alignas(64) tp_multiband {
+        tp_lanefilter F[MB_Stages];
+        float Env[2][4];
+        float GainAdj[2][4];
+        int Bands;
+    };
+    tp_multiband MB = {};
+    int MB_Serial = 0;
+    void Mako_MB_Design(int Bands, tp_multiband& Out);
+    void Mako_MB_SetLane(tp_multiband& Out, int Stage, int Lane, float a0, float a1, float a2, float b1, float b2);
+
+    //R1.01 The cab convolver is handed to the audio thread the same way as the stage list.
+    //R1.01 The slot we get back from Publish is never in use by the audio thread, so old convolvers
+    //R1.01 are always deleted on the control thread.
+    tp_handoff<std::unique_ptr<MakoConvolver>> Cab;
+    MakoConvolver* Cab_Live = nullptr;
+    std::shared_ptr<const MakoIR> IR_Current;
+
+    //R1.01 LIMITER. The coefficient thread works out the lookahead in samples, then the audio thread
+    //R1.01 picks it up and restarts the limiter.
+    MakoLimiter Limiter;
+    std::atomic<int> Limit_Ahead{ 0 };
+    int Mako_Limit_Ahead(int Mode) const;
+
+    //R1.01 MICRO-BLOCK SCHEDULER. Hosts may call us with 1 sample or thousands, and not always the same.
+    //R1.01 The control work (picking up coefficients, the stage list and cab IR, deciding on metering, reading
+    //R1.01 the quality tier and timing a block for it) runs on a tick every Ctl_Interval samples, or once per
+    //R1.01 call for bigger blocks. Calls in between only run the stages.
+    static constexpr int Ctl_Interval = 32;
+    int Ctl_Count = 0;                  //R1.01 Samples until the next tick, 0 or less ticks.
+    int Ctl_Tier = e_Tier_Full;
+    const tp_stagelist* Stages_Live = nullptr;
+    void Mako_Control_Tick();
+
+    //R1.01 Adaptive quality. Smoothed CPU load (1.0 = the whole block time), and sample counters
+    //R1.01 for the wait after a step down and the time spent with headroom. Only the call after a tick is timed,
+    //R1.01 Q_Elapsed counts every sample since the last timed one.
+    float Q_Load = 0.0f;
+    int Q_Hold = 0;
+    int Q_Calm = 0;
+    int Q_Elapsed = 0;
+    void Mako_Quality_Update(double Used, int Samples);
+
+    //R1.01 Tier changes in the EQ/Gain stage are crossfaded over Block_Max samples, carried from call to call
+    //R1.01 so the fade is the same length whatever the host block size. 0 = band off / exact tanh, 1 = on / cheap tanh.
+    //R1.01 EQ bands fade per channel, [channel][band].
+    float Band_Mix[2][3] = {};
+    float Drive_Mix = 0.0f;
+
+    //R1.01 DRIVE ANTI-ALIASING. The order is picked up on the control tick, the quality tiers leave it alone.
+    //R1.01 Each channel keeps its last two inputs, a new order or a channel without drive starts over.
+    int AA_Order = e_DriveAA_Off;
+    MakoKernels::tp_aastate AA_State[2] = {};
+
+
+    //R1.01 Copy all per channel DSP state from one channel to the other.
+    void Mako_State_CopyChannel(int From, int To);
+
+    //R1.01 Clear all DSP state as if the input had been silent forever. Coefficients are kept.
+    void Mako_State_Reset();
+
+    //R1.01 Run the stage list over a block, in chunks of at most Block_Max samples.
+    void Mako_Stages_Run(const tp_stagelist& Stages, float* const* Data, int Channels, int Samples);
+
+    //R1.01 BYPASS. The dry input is kept in a ring so it can be delayed by our latency. Byp_Mix 0 is our
+    //R1.01 processed sound and 1 is fully bypassed, where no DSP runs at all.
+    float Byp_Mix = 0.0f;
+    std::vector<float> Byp_Dry[2];
+    int Byp_Size = 0;                   //R1.01 Power of 2, set in Prepare.
+    int Byp_Write = 0;
+    void Mako_Bypass_Dry(float* const* Data, int Channels, int Samples, int Lat);
+    void Mako_Bypass_Warm(const tp_stagelist& Stages, int Channels, int Lat);
+    void Mako_Bypass_Mix(float* const* Data, int Channels, int Samples, int Lat, bool Bypass);
+
+    //R1.01 Our actual AUDIO adjusting functions are the kernels for the instruction set picked in Prepare.
+    const MakoKernels::tp_table* Kernels = &MakoKernels::Get(MakoKernels::e_Path_Auto);
+    MakoKernels::tp_comp Mako_Comp_Settings(int Channel) const;
+
+    //R1.00 Some Constants and vars.
+    const float pi = 3.14159265f;
+    const float pi2 = 6.2831853f;
+    const float sqrt2 = 1.4142135f;
+    float SampleRate = 48000.0f;
+
+    //R1.00 Calc some times based on sample rate for compressors, etc.
+    float Release_5mS = 0.0f;
+    float Release_10mS = 0.0f;
+    float Release_50mS = 0.0f;
+    float Release_100mS = 0.0f;
+    float Release_200mS = 0.0f;
+    float Release_300mS = 0.0f;
+    float Release_400mS = 0.0f;
+    float Release_500mS = 0.0f;
+
+    //R1.00 OUR FILTER VARIABLES
+    //R1.01 Trimmed to what the biquad code actually uses.
+    struct tp_coeffs {
+        float a0;
+        float a1;
+        float a2;
+        float b1;
+        float b2;
+    };
+
+    //R1.01 The kernels use the same filter layout.
+    typedef MakoKernels::tp_filter tp_filter;
+
+    //R1.01 Precalculated filter coefficients for every knob position at one sample rate.
+    //R1.01 Low Cut is 20-200 Hz in 1 Hz steps, EQ bands are -12 to +12 dB in .1 dB steps.
+    //R1.01 The tables are shared by every engine in the process, see Mako_Tables_Get.
+    struct tp_coefftable {
+        float SampleRate;
+        tp_coeffs LowCut[181];
+        tp_coeffs EQ[3][241];
+    };
+    const tp_coefftable* CoeffTable = nullptr;
+    const tp_coefftable* Mako_Tables_Get();
+    void Filter_Set_Coeffs(const tp_coeffs& Co, tp_filter* fn, int channel);
+
+    //R1.00 FILTER FUNCTIONS
+    //R1.01 The coefficient functions fill a tp_coeffs, a filter holds one set per channel.
+    float Filter_Calc_BiQuad(float tSample, int channel, tp_filter* fn);
+    void Filter_BP_Coeffs(float Gain_dB, float Fc, float Q, tp_coeffs* fn);
+    void Filter_LP_Coeffs(float fc, tp_coeffs* fn);
+    void Filter_HP_Coeffs(float fc, tp_coeffs* fn);
+
+    //R1.00 Our pedal filters and function def.
+    //R1.01 Everything the audio thread touches per sample lives in this one cache line aligned block.
+    struct alignas(64) tp_dsp {
+        tp_filter makoF_LowCut;
+        tp_filter makoF_Low;
+        tp_filter makoF_Mid;
+        tp_filter makoF_High;
+
+        float Pedal_NGate_Fac[2];    //R1.00 Noise Gate.
+
+        float Det_Peak[2];           //R1.01 Shared envelope detector.
+        float Det_MS[2];
+        float CompDet_Peak[2];       //R1.01 Compressor's own detector.
+        float CompDet_MS[2];
+
+        float Pedal_CompGain[2];     //R1.00 Compressor vars.
+        float Pedal_CompGainAdj[2];
+    };
+    tp_dsp Dsp = {};
+
+    //R1.01 DYNAMIC EQ. The band gains follow band pass detectors, so the EQ filters' a0 and a2 are ours while
+    //R1.01 it runs. EQ_Static keeps the knob coefficients from the last set, they are put back when it stops.
+    //R1.01 Turning it off keeps it running for two control steps with the ratio at 1 (Dyn_Exit counts down),
+    //R1.01 so the gains glide back to the knobs first.
+    MakoKernels::tp_dynset Dyn = {};
+    MakoKernels::tp_dynstate Dyn_State = {};
+    bool Dyn_On = false;
+    bool Dyn_Active = false;
+    int Dyn_Exit = 0;
+    tp_coeffs EQ_Static[2][3] = {};
+    bool Mako_Dyn_EQ(float* const* Data, int Channels, int Samples);
+
+    //R1.01 COEFFICIENT THREAD. Works out the coefficients for the settings flagged dirty and hands the
+    //R1.01 finished set to the audio thread, which only copies it in. Unchanged parts carry over in Coeff_Work.
+    struct tp_coeffset {
+        float Setting[2][e_Setting_Count];
+        bool Linked;
+        tp_coeffs LowCut[2];
+        tp_coeffs EQ[2][3];
+        bool DynEQ;
+        MakoKernels::tp_dynset Dyn;
+        float Det_PeakDecay;
+        float Det_RMSCoef;
+        int MB_Serial;                  //R1.01 Bumped each time the crossovers are redesigned.
+        float MB_Rate;                  //R1.01 Sample rate the crossovers were designed for.
+        tp_multiband MB;                //R1.01 Crossovers with clear filter state.
+    };
+    tp_handoff<tp_coeffset> Coeffs;
+    tp_coeffset Coeff_Work = {};        //R1.01 Only touched with Coeff_Lock held.
+    std::atomic<uint32_t> Settings_Dirty{ 0 };
+    std::mutex Coeff_Lock;              //R1.01 Never taken by the audio thread.
+    void Mako_Coeffs_Compute(uint32_t Bits);
+
+    //R1.01 The COEFFICIENT THREAD is one thread for every engine in the process, started with the first engine
+    //R1.01 and stopped with the last. It sleeps until an engine flags a setting, then serves every dirty engine.
+    //R1.01 Coeff_Crew is the thread (and its wake up) this engine posts to.
+    struct tp_coeffcrew;
+    struct tp_coeffpool;
+    std::shared_ptr<tp_coeffcrew> Coeff_Crew;
+    void Mako_Coeffs_Apply(const tp_coeffset& Set);
+};
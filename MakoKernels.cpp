@@ -0,0 +1,106 @@
+/*
+  ==============================================================================
+
+    MakoKernels.cpp
+    R1.01 Base kernels and the CPU check that picks a path. See MakoKernels.h.
+
+  ==============================================================================
+*/
+
+#include "MakoKernels.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#if MAKO_KERNELS_X86 && defined(_MSC_VER)
+ #include <intrin.h>
+#endif
+
+//R1.01 BASE kernels, built with the project's own settings.
+#define MAKO_KERNEL_NS      Mako_Kernels_Base
+#define MAKO_KERNEL_TABLE   Mako_Kernels_Base_Table
+#if MAKO_KERNELS_X86
+ #define MAKO_KERNEL_NAME   "SSE2"
+#else
+ #define MAKO_KERNEL_NAME   "Generic"
+#endif
+#define MAKO_KERNEL_PATH    MakoKernels::e_Path_Base
+#include "MakoKernelsImpl.h"
+
+//R1.01 The other tables live in MakoKernels_AVX2.cpp and MakoKernels_AVX512.cpp.
+#if MAKO_KERNELS_X86
+extern const MakoKernels::tp_table Mako_Kernels_AVX2_Table;
+extern const MakoKernels::tp_table Mako_Kernels_AVX512_Table;
+#endif
+
+//R1.01 Ask the CPU (and the OS, it has to save the wide registers) what it can run.
+static int Mako_Kernels_Detect()
+{
+#if MAKO_KERNELS_X86 && defined(_MSC_VER)
+    int r[4];
+    __cpuid(r, 0);
+    if (r[0] < 7) return MakoKernels::e_Path_Base;
+
+    //R1.01 AVX and FMA, and the OS saves the YMM registers.
+    __cpuid(r, 1);
+    bool OSSave = (r[2] & (1 << 27)) != 0;
+    bool FMA = (r[2] & (1 << 12)) != 0;
+    if (!OSSave || !FMA || ((r[2] & (1 << 28)) == 0)) return MakoKernels::e_Path_Base;
+    unsigned long long XCR0 = _xgetbv(0);
+    if ((XCR0 & 0x6) != 0x6) return MakoKernels::e_Path_Base;
+
+    __cpuidex(r, 7, 0);
+    if ((r[1] & (1 << 5)) == 0) return MakoKernels::e_Path_Base;
+
+    //R1.01 AVX-512 F, DQ, BW and VL, and the OS saves the ZMM and mask registers.
+    const int AVX512 = (1 << 16) | (1 << 17) | (1 << 30) | (1 << 31);
+    if (((r[1] & AVX512) == AVX512) && ((XCR0 & 0xE6) == 0xE6)) return MakoKernels::e_Path_AVX512;
+    return MakoKernels::e_Path_AVX2;
+#elif MAKO_KERNELS_X86 && defined(__GNUC__)
+    __builtin_cpu_init();
+    if (!__builtin_cpu_supports("avx2") || !__builtin_cpu_supports("fma")) return MakoKernels::e_Path_Base;
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq") &&
+        __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512vl")) return MakoKernels::e_Path_AVX512;
+    return MakoKernels::e_Path_AVX2;
+#else
+    return MakoKernels::e_Path_Base;
+#endif
+}
+
+int MakoKernels::Best()
+{
+    //R1.01 The CPU does not change, ask once.
+    static const int Path = Mako_Kernels_Detect();
+    return Path;
+}
+
+const char* MakoKernels::Name(int Path)
+{
+    static const char* PathName[e_Path_Count] = { "Auto", MAKO_KERNEL_NAME, "AVX2", "AVX-512" };
+    return ((0 <= Path) && (Path < e_Path_Count)) ? PathName[Path] : "";
+}
+
+const MakoKernels::tp_table& MakoKernels::Get(int Path)
+{
+    //R1.01 Auto can be overridden for benchmarks and reproducible renders.
+    if (Path == e_Path_Auto)
+    {
+        const char* Env = std::getenv("MAKO_KERNELS");
+        if (Env != nullptr)
+        {
+            if (strcmp(Env, "base") == 0) Path = e_Path_Base;
+            if (strcmp(Env, "avx2") == 0) Path = e_Path_AVX2;
+            if (strcmp(Env, "avx512") == 0) Path = e_Path_AVX512;
+        }
+    }
+
+    //R1.01 Never run a path the CPU does not have.
+    int Max = Best();
+    if ((Path <= e_Path_Auto) || (e_Path_Count <= Path) || (Max < Path)) Path = Max;
+
+#if MAKO_KERNELS_X86
+    if (Path == e_Path_AVX512) return Mako_Kernels_AVX512_Table;
+    if (Path == e_Path_AVX2) return Mako_Kernels_AVX2_Table;
+#endif
+    return Mako_Kernels_Base_Table;
+}
@@ -0,0 +1,208 @@
+/*
+  ==============================================================================
+
+    MakoKernels.h
+    R1.01 DSP KERNELS built for more than one instruction set.
+
+    The per sample loops of the stages (biquad filter, noise gate, compressor,
+    drive, envelope detector/metering and the multiband compressor) are written
+    once in MakoKernelsImpl.h as plain loops and compiled three times:
+    * Base    - MakoKernels.cpp, SSE2 (every x64 CPU), or whatever the CPU has on other platforms.
+    * AVX2    - MakoKernels_AVX2.cpp, AVX2 + FMA.
+    * AVX-512 - MakoKernels_AVX512.cpp, AVX-512 F/VL/BW/DQ.
+
+    The engine picks one table of kernels in Prepare. Every kernel
+    works on a whole block, so there is one function pointer call per block
+    and never any dispatch per sample.
+
+    Plain C++, no JUCE needed.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+ #define MAKO_KERNELS_X86 1
+#else
+ #define MAKO_KERNELS_X86 0
+#endif
+
+//R1.01 Cheap tanh for the lower quality tiers. Pade approximation, within .0001 of tanhf, clamped at +-1.
+//R1.01 The clamp is done with selects, not early returns, so loops using it still vectorize.
+//R1.01 static so every kernel file gets its own copy built for its own instruction set.
+static inline float Mako_FastTanh(float x)
+{
+    float x2 = x * x;
+    float y = x * (135135.0f + x2 * (17325.0f + x2 * (378.0f + x2))) / (135135.0f + x2 * (62370.0f + x2 * (3150.0f + x2 * 28.0f)));
+    y = (4.97f < x) ? 1.0f : y;
+    y = (x < -4.97f) ? -1.0f : y;
+    return y;
+}
+
+//R1.01 Cheap log2 and 2^x for control rate gain math (dynamic EQ), within .00002 (about .0001 dB).
+//R1.01 Bit tricks and polynomials only, no library calls, so a loop over lanes vectorizes. Log2 needs x above 0.
+static inline float Mako_FastLog2(float x)
+{
+    uint32_t i;
+    memcpy(&i, &x, 4);
+    float e = float(int32_t(i >> 23) - 127);
+    i = (i & 0x007FFFFFu) | 0x3F800000u;
+    float m;
+    memcpy(&m, &i, 4);
+    float z = (m - 1.0f) / (m + 1.0f);
+    float z2 = z * z;
+    return e + z * (2.8853901f + z2 * (.96179669f + z2 * (.57707801f + z2 * .41219858f)));
+}
+
+static inline float Mako_FastExp2(float x)
+{
+    x = (x < -126.0f) ? -126.0f : x;
+    x = (127.0f < x) ? 127.0f : x;
+    float n = float(int32_t(x));
+    n = (x < n) ? n - 1.0f : n;
+    float f = (x - n) * .69314718f;
+    float p = 1.0f + f * (1.0f + f * (.5f + f * (.16666667f + f * (.041666668f + f * (.0083333338f + f * .0013888889f)))));
+    uint32_t i = uint32_t(int32_t(n) + 127) << 23;
+    float s;
+    memcpy(&s, &i, 4);
+    return p * s;
+}
+
+struct MakoKernels
+{
+    //R1.01 Instruction set paths. Auto picks the best one this CPU can run.
+    enum { e_Path_Auto, e_Path_Base, e_Path_AVX2, e_Path_AVX512, e_Path_Count };
+
+    //R1.01 Drive modes: gain only (drive at 0), tanhf, or the cheap tanh.
+    enum { e_Drive_Gain, e_Drive_Exact, e_Drive_Fast };
+
+    //R1.01 One biquad filter. Coefficients and state for Left and Right, so in DUAL MONO the
+    //R1.01 channels can have their own settings and still be filtered together, one lane each.
+    struct tp_filter {
+        float a0[2];
+        float a1[2];
+        float a2[2];
+        float b1[2];
+        float b2[2];
+        float xn0[2];
+        float xn1[2];
+        float xn2[2];
+        float yn1[2];
+        float yn2[2];
+    };
+
+    //R1.01 One stage of the multiband cascade. One lane per band, state for Left and Right.
+    //R1.01 The state of both channels sits side by side, so stereo fills 8 lanes.
+    static constexpr int MB_Stages = 6;
+    static constexpr int MB_Short = 16;     //R1.01 Blocks shorter than this filter the state in place.
+    struct alignas(16) tp_lanefilter {
+        float a0[4];
+        float a1[4];
+        float a2[4];
+        float b1[4];
+        float b2[4];
+        float xn1[2][4];
+        float xn2[2][4];
+        float yn1[2][4];
+        float yn2[2][4];
+    };
+
+    //R1.01 DYNAMIC EQ settings from the coefficient thread. One lane per EQ band, lane 3 is unused.
+    //R1.01 Each band has a band pass detector at its own frequency. Over the threshold the band's gain
+    //R1.01 (the EQ knob, in dB) is pulled down by Slope dB per dB, and held within +-12 dB.
+    //R1.01 The peaking filter is a0 = C0 + V * C1, a2 = C0 - V * C1 with V the gain as a ratio,
+    //R1.01 a1, b1 and b2 do not depend on the gain. So moving a0 and a2 in a straight line moves V in one too.
+    static constexpr int Dyn_Step = 16;     //R1.01 Control rate, the gains are worked out every this many samples.
+    struct alignas(16) tp_dynset {
+        float d_a0[4];          //R1.01 Detector band pass, a1 is 0 and a2 is -a0.
+        float d_b1[4];
+        float d_b2[4];
+        float Attack[4];        //R1.01 Envelope one pole coefficients.
+        float Release[4];
+        float Thresh[4];        //R1.01 In dB.
+        float Slope[4];         //R1.01 1 - 1 / Ratio.
+        float Static[2][4];     //R1.01 The EQ knobs in dB, per channel.
+        float C0[4];
+        float C1[4];
+    };
+
+    //R1.01 Dynamic EQ detector state, [channel][band]. Step0 and Step2 are how far a0 and a2 of each EQ
+    //R1.01 filter move per sample, Phase the samples since the gains were last worked out.
+    struct alignas(16) tp_dynstate {
+        float x1[2][4];
+        float x2[2][4];
+        float y1[2][4];
+        float y2[2][4];
+        float Env[2][4];
+        float Step0[2][4];
+        float Step2[2][4];
+        int Phase;
+    };
+
+    //R1.01 ADAA drive state of one channel, the last two inputs times Drive. Primed 0 starts over from the next sample.
+    struct tp_aastate {
+        double x1;
+        double x2;
+        int Primed;
+    };
+
+    //R1.01 Compressor settings. Attack and Release are gain steps per sample.
+    //R1.01 Each channel has its own, for DUAL MONO.
+    struct tp_comp {
+        float Thresh;
+        float Ratio;
+        float Attack;
+        float Release;
+        float PeakDecay;    //R1.01 Multiband only, the band level detectors.
+    };
+
+    //R1.01 One set of kernels. All of them run over a block of samples in place.
+    struct tp_table {
+        const char* Name;
+        int Path;
+
+        //R1.01 Biquad for one channel, and for both channels together in one pass.
+        void (*BiQuad)(float* Data, int Samples, tp_filter* F, int Channel);
+        void (*BiQuad2)(float* const* Data, int Samples, tp_filter* F);
+
+        //R1.01 Noise gate. The gain follows Env (RMS) * 10000 * Scale, at most 1. Fac keeps the last gain.
+        void (*Gate)(float* Data, const float* Env, int Samples, float Scale, float* Fac);
+
+        //R1.01 Gain and drive curve, Mode is one of the e_Drive_ values.
+        void (*Drive)(float* Data, int Samples, float Gain, float Drive, int Mode);
+
+        //R1.01 Same curve anti-aliased with antiderivatives (ADAA), Order 1 or 2. S carries the history between blocks.
+        void (*DriveAA)(float* Data, int Samples, float Gain, float Drive, int Order, tp_aastate* S);
+
+        //R1.01 Envelope detector. Writes the peak and RMS envelopes for Data, carries the state in P and M
+        //R1.01 (peak and mean square) and returns the highest peak for the meters.
+        float (*Detect)(const float* Data, float* Pk, float* Rm, int Samples, float PeakDecay, float RMSCoef, float* P, float* M);
+
+        //R1.01 Single band compressor. Level is the peak envelope, Gain and Adj its per channel state.
+        void (*Comp)(float* Data, const float* Level, int Samples, const tp_comp& C, float* Gain, float* Adj);
+
+        //R1.01 Multiband compressor, 1 or 2 channels at once. Mask picks the channels (bit 0 Left, bit 1 Right),
+        //R1.01 Env and Adj are [channel][band] and C has the settings for each channel.
+        void (*MultiBand)(float* const* Data, int Mask, int Samples, tp_lanefilter* F, float (*Env)[4], float (*Adj)[4], const tp_comp* C);
+
+        //R1.01 Dynamic EQ, 1 or 2 channels. Band is the 3 EQ filters, their a0 and a2 are moved to the new gains.
+        //R1.01 The gains are worked out every Dyn_Step samples counted across calls, whatever the block size.
+        void (*DynEQ)(float* const* Data, int Channels, int Samples, tp_filter* const* Band, const tp_dynset& D, tp_dynstate* S);
+    };
+
+    //R1.01 Best path this CPU and OS can run.
+    static int Best();
+
+    //R1.01 The kernels for a path. Auto, or a path this CPU can not run, gives the best one that works.
+    //R1.01 With Auto the MAKO_KERNELS environment variable (base, avx2 or avx512) picks the path instead,
+    //R1.01 for A/B benchmarks and renders that must match across machines.
+    static const tp_table& Get(int Path);
+
+    //R1.01 Name of a path, for menus and reports.
+    static const char* Name(int Path);
+};
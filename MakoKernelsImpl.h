@@ -0,0 +1,654 @@
+/*
+  ==============================================================================
+
+    MakoKernelsImpl.h
+    R1.01 Kernel bodies. See MakoKernels.h.
+
+    Included once by each MakoKernels*.cpp file after it has set its
+    instruction set. The file also names the namespace (MAKO_KERNEL_NS), the
+    table (MAKO_KERNEL_TABLE), its name and path. The kernels are static in
+    their own namespace, so the linker can never mix the copies up.
+
+    The loops are kept simple so the compiler can vectorize them. Loops that
+    carry a value from one sample to the next (filters, envelopes) can not,
+    they gain from FMA and the shorter instruction forms only.
+
+  ==============================================================================
+*/
+
+#ifndef MAKO_KERNEL_NS
+ #error "MakoKernelsImpl.h is only included by the MakoKernels*.cpp files."
+#endif
+
+namespace MAKO_KERNEL_NS
+{
+    //R1.01 BIQUAD. The state is kept in locals for the whole block.
+    static void BiQuad(float* Data, int Samples, MakoKernels::tp_filter* F, int Channel)
+    {
+        if (Samples <= 0) return;
+
+        const float a0 = F->a0[Channel], a1 = F->a1[Channel], a2 = F->a2[Channel], b1 = F->b1[Channel], b2 = F->b2[Channel];
+        float x1 = F->xn1[Channel], x2 = F->xn2[Channel];
+        float y1 = F->yn1[Channel], y2 = F->yn2[Channel];
+
+        for (int samp = 0; samp < Samples; samp++)
+        {
+            float x0 = Data[samp];
+            float y = a0 * x0 + a1 * x1 + a2 * x2 - b1 * y1 - b2 * y2;
+            x2 = x1; x1 = x0;
+            y2 = y1; y1 = y;
+            Data[samp] = y;
+        }
+
+        F->xn0[Channel] = x1;
+        F->xn1[Channel] = x1; F->xn2[Channel] = x2;
+        F->yn1[Channel] = y1; F->yn2[Channel] = y2;
+    }
+
+    //R1.01 STEREO BIQUAD. Left and Right are two lanes with their own coefficients. The two filters do not
+    //R1.01 depend on each other, so they run side by side instead of one waiting on the other's feedback.
+    static void BiQuad2(float* const* Data, int Samples, MakoKernels::tp_filter* F)
+    {
+        if (Samples <= 0) return;
+
+        float a0[2], a1[2], a2[2], b1[2], b2[2];
+        float x1[2], x2[2], y1[2], y2[2], y[2];
+        for (int k = 0; k < 2; k++)
+        {
+            a0[k] = F->a0[k]; a1[k] = F->a1[k]; a2[k] = F->a2[k]; b1[k] = F->b1[k]; b2[k] = F->b2[k];
+            x1[k] = F->xn1[k]; x2[k] = F->xn2[k];
+            y1[k] = F->yn1[k]; y2[k] = F->yn2[k];
+        }
+        float* L = Data[0];
+        float* R = Data[1];
+
+        for (int samp = 0; samp < Samples; samp++)
+        {
+            float x0[2] = { L[samp], R[samp] };
+            for (int k = 0; k < 2; k++)
+            {
+                y[k] = a0[k] * x0[k] + a1[k] * x1[k] + a2[k] * x2[k] - b1[k] * y1[k] - b2[k] * y2[k];
+                x2[k] = x1[k]; x1[k] = x0[k];
+                y2[k] = y1[k]; y1[k] = y[k];
+            }
+            L[samp] = y[0];
+            R[samp] = y[1];
+        }
+
+        for (int k = 0; k < 2; k++)
+        {
+            F->xn0[k] = x1[k];
+            F->xn1[k] = x1[k]; F->xn2[k] = x2[k];
+            F->yn1[k] = y1[k]; F->yn2[k] = y2[k];
+        }
+    }
+
+    //R1.01 NOISE GATE. The gain only depends on the envelope, so this is fully vectorized.
+    static void Gate(float* Data, const float* Env, int Samples, float Scale, float* Fac)
+    {
+        if (Samples <= 0) return;
+
+        for (int samp = 0; samp < Samples; samp++)
+        {
+            float g = Env[samp] * 10000.0f * Scale;
+            g = (1.0f < g) ? 1.0f : g;
+            Data[samp] *= g;
+        }
+
+        float g = Env[Samples - 1] * 10000.0f * Scale;
+        *Fac = (1.0f < g) ? 1.0f : g;
+    }
+
+    //R1.01 GAIN and DRIVE. tanhf is a library call, the cheap tanh and plain gain vectorize.
+    static void Drive(float* Data, int Samples, float Gain, float Drive, int Mode)
+    {
+        if (Mode == MakoKernels::e_Drive_Gain)
+            for (int samp = 0; samp < Samples; samp++) Data[samp] *= Gain;
+        else if (Mode == MakoKernels::e_Drive_Fast)
+            for (int samp = 0; samp < Samples; samp++) Data[samp] = Gain * Mako_FastTanh(Data[samp] * Drive);
+        else
+            for (int samp = 0; samp < Samples; samp++) Data[samp] = Gain * tanhf(Data[samp] * Drive);
+    }
+
+    //R1.01 ADAA DRIVE helpers. Anti-derivative anti-aliasing takes divided differences of the tanh curve's
+    //R1.01 antiderivatives, which cancel far too much in float, so this runs in double.
+    //R1.01 e^x for -700 <= x <= 0. Rounds to the nearest power of 2 with the magic number trick and builds it
+    //R1.01 from bits, so the loops calling it vectorize without SSE4.1 or int64 conversions.
+    static inline double AA_Exp(double x)
+    {
+        double n = (x * 1.4426950408889634 + 6755399441055744.0) - 6755399441055744.0;
+        double r = (x - n * .693147180369123816) - n * 1.90821492927058770e-10;
+        double p = 1.0 + r * (1.0 + r * (1.0 / 2 + r * (1.0 / 6 + r * (1.0 / 24 + r * (1.0 / 120 + r * (1.0 / 720 + r * (1.0 / 5040
+                 + r * (1.0 / 40320 + r * (1.0 / 362880 + r * (1.0 / 3628800 + r * (1.0 / 39916800 + r * (1.0 / 479001600))))))))))));
+        double b = n + (1023.0 + 4503599627370496.0);
+        uint64_t i;
+        memcpy(&i, &b, 8);
+        i <<= 52;
+        double s;
+        memcpy(&s, &i, 8);
+        return p * s;
+    }
+
+    //R1.01 tanh(x) = T, ln(cosh(x)) = F1 and its antiderivative F2, from 0, for a block of X.
+    //R1.01 With t = |x|, u = e^(-2t) and L = ln(1 + u):
+    //R1.01   T = sign(x) (1 - u) / (1 + u)
+    //R1.01   F1 = t - ln 2 + L
+    //R1.01   F2 = sign(x) (t^2 / 2 - t ln 2 + Li2(-u) / 2 + pi^2 / 24), Li2 the dilogarithm.
+    //R1.01 L comes from the atanh series with z = u / (2 + u) <= 1/3. -Li2(-u) is a short series in L
+    //R1.01 (Bernoulli numbers), since u / (1 + u) = 1 - e^-L. Both good to about 1e-15.
+    static void AA_Curve(const double* X, int n, double* T, double* F1, double* F2)
+    {
+        for (int i = 0; i < n; i++)
+        {
+            double s = (X[i] < 0.0) ? -1.0 : 1.0;
+            double t = fabs(X[i]);
+            double u = AA_Exp(-2.0 * t);
+            double z = u / (2.0 + u);
+            double z2 = z * z;
+            double L = 2.0 * z * (1.0 + z2 * (1.0 / 3 + z2 * (1.0 / 5 + z2 * (1.0 / 7 + z2 * (1.0 / 9 + z2 * (1.0 / 11 + z2 * (1.0 / 13
+                     + z2 * (1.0 / 15 + z2 * (1.0 / 17 + z2 * (1.0 / 19 + z2 * (1.0 / 21 + z2 * (1.0 / 23 + z2 * (1.0 / 25 + z2 * (1.0 / 27))))))))))))));
+            double L2 = L * L;
+            double Li = L * (1.0 + L * (1.0 / 4 + L * (1.0 / 36 - L2 * (1.0 / 3600 - L2 * (1.0 / 211680 - L2 * (1.0 / 10886400
+                      - L2 * (1.0 / 526901760 - L2 * (4.0647616451442255e-11 - L2 * 8.9216910204564526e-13))))))));
+            T[i] = s * (1.0 - u) / (1.0 + u);
+            F1[i] = t - .69314718055994531 + L;
+            F2[i] = s * (t * (.5 * t - .69314718055994531) - .5 * Li + .41123351671205660);
+        }
+    }
+
+    //R1.01 ADAA DRIVE. Gain * tanh(Drive * x), anti-aliased to the first or second order:
+    //R1.01   1st: y = (F1(x0) - F1(x1)) / (x0 - x1)                                  half a sample late
+    //R1.01   2nd: y = 2 / (x0 - x2) * (D(x0, x1) - D(x1, x2)), D(a, b) = (F2(a) - F2(b)) / (a - b)   one sample late
+    //R1.01 Nearly equal inputs would divide noise by nothing, so under AA_Tol the formulas are swapped for their
+    //R1.01 expansions around the midpoint. Every path is worked out for every sample and picked with a select,
+    //R1.01 so the loops vectorize and the cost does not depend on the signal.
+    //R1.01 The selects are blends and the divisors are kept off 0, a division only taken on one side of a
+    //R1.01 branch stops the compiler vectorizing. Inputs are held within +-300, tanh is 1 there in double.
+    static constexpr double AA_Tol = 1.0e-4;
+    static constexpr double AA_Max = 300.0;
+    static constexpr int AA_Chunk = 64;
+
+    static inline double AA_Divisor(double d)
+    {
+        double a = fabs(d);
+        return copysign((a < AA_Tol) ? AA_Tol : a, d);
+    }
+
+    static void DriveAA(float* Data, int Samples, float Gain, float Drive, int Order, MakoKernels::tp_aastate* S)
+    {
+        if (Samples <= 0) return;
+
+        //R1.01 Starting, the history is the first sample so the first outputs are plain tanh.
+        if (!S->Primed)
+        {
+            double x = double(Data[0]) * Drive;
+            x = (x < -AA_Max) ? -AA_Max : x;
+            S->x1 = S->x2 = (AA_Max < x) ? AA_Max : x;
+            S->Primed = 1;
+        }
+
+        //R1.01 X[0] and X[1] are the two samples before the chunk. The curve at X, at the midpoints M
+        //R1.01 and, for the second order, at B and H (below).
+        alignas(64) double X[AA_Chunk + 2], T[AA_Chunk + 2], F1[AA_Chunk + 2], F2[AA_Chunk + 2];
+        alignas(64) double M[AA_Chunk + 2], Tm[AA_Chunk + 2], F1m[AA_Chunk + 2], F2m[AA_Chunk + 2], D[AA_Chunk + 2];
+        alignas(64) double B[AA_Chunk], Tb[AA_Chunk], F1b[AA_Chunk], F2b[AA_Chunk], Y[AA_Chunk];
+        const double G = Gain;
+
+        for (int Start = 0; Start < Samples; Start += AA_Chunk)
+        {
+            const int n = (Samples - Start < AA_Chunk) ? Samples - Start : AA_Chunk;
+            float* cD = Data + Start;
+
+            X[0] = S->x2;
+            X[1] = S->x1;
+            for (int i = 0; i < n; i++)
+            {
+                double x = double(cD[i]) * Drive;
+                x = (x < -AA_Max) ? -AA_Max : x;
+                X[i + 2] = (AA_Max < x) ? AA_Max : x;
+            }
+            AA_Curve(X, n + 2, T, F1, F2);
+
+            //R1.01 M[i] is halfway between X[i] and X[i + 1].
+            for (int i = 0; i < n + 1; i++) M[i] = .5 * (X[i] + X[i + 1]);
+            AA_Curve(M, n + 1, Tm, F1m, F2m);
+
+            if (Order <= 1)
+            {
+                //R1.01 Near: tanh at the midpoint plus its curvature, f + f'' dx^2 / 24, f'' = -2 T (1 - T^2).
+                for (int i = 0; i < n; i++)
+                {
+                    double dx = X[i + 2] - X[i + 1];
+                    double Near = (fabs(dx) < AA_Tol) ? 1.0 : 0.0;
+                    double Mid = Tm[i + 1] - Tm[i + 1] * (1.0 - Tm[i + 1] * Tm[i + 1]) * dx * dx * (1.0 / 12);
+                    double Far = (F1[i + 2] - F1[i + 1]) / AA_Divisor(dx);
+                    Y[i] = Far + Near * (Mid - Far);
+                }
+            }
+            else
+            {
+                //R1.01 D[i] for the pair X[i], X[i + 1]. Near: F1 at the midpoint plus its curvature, F1'' = 1 - T^2.
+                for (int i = 0; i < n + 1; i++)
+                {
+                    const double* F = F2 + i;
+                    double dx = X[i + 1] - X[i];
+                    double Near = (fabs(dx) < AA_Tol) ? 1.0 : 0.0;
+                    double Mid = F1m[i] + (1.0 - Tm[i] * Tm[i]) * dx * dx * (1.0 / 24);
+                    double Far = (F[1] - F[0]) / AA_Divisor(dx);
+                    D[i] = Far + Near * (Mid - Far);
+                }
+
+                //R1.01 x0 near x2: the limit at their midpoint B, 2 / d * (F1(B) + (F2(x1) - F2(B)) / d) with d = B - x1,
+                //R1.01 and tanh at H, halfway between B and x1, if x1 is near as well.
+                for (int i = 0; i < n; i++) B[i] = .5 * (X[i] + X[i + 2]);
+                AA_Curve(B, n, Tb, F1b, F2b);
+                for (int i = 0; i < n; i++) M[i] = .5 * (B[i] + X[i + 1]);
+                AA_Curve(M, n, Tm, F1m, F2m);
+
+                for (int i = 0; i < n; i++)
+                {
+                    double d2 = X[i + 2] - X[i];
+                    double Near = (fabs(d2) < AA_Tol) ? 1.0 : 0.0;
+                    double Far = 2.0 * (D[i + 1] - D[i]) / AA_Divisor(d2);
+
+                    double d = B[i] - X[i + 1];
+                    double Flat = (fabs(d) < AA_Tol) ? 1.0 : 0.0;
+                    double dd = AA_Divisor(d);
+                    double Mid = 2.0 / dd * (F1b[i] + (F2[i + 1] - F2b[i]) / dd);
+                    Mid += Flat * (Tm[i] - Mid);
+                    Y[i] = Far + Near * (Mid - Far);
+                }
+            }
+
+            for (int i = 0; i < n; i++) cD[i] = float(G * Y[i]);
+            S->x2 = X[n];
+            S->x1 = X[n + 1];
+        }
+    }
+
+    //R1.01 ENVELOPE DETECTOR and input METERING.
+    //R1.01 The abs, square and sqrt passes are vectorized, only the one pole smoothing runs sample by sample.
+    static float Detect(const float* Data, float* Pk, float* Rm, int Samples, float PeakDecay, float RMSCoef, float* P, float* M)
+    {
+        float p = *P;
+        float m = *M;
+        float Max = 0.0f;
+
+        for (int samp = 0; samp < Samples; samp++) Pk[samp] = fabsf(Data[samp]);
+        for (int samp = 0; samp < Samples; samp++) Rm[samp] = Data[samp] * Data[samp];
+
+        for (int samp = 0; samp < Samples; samp++)
+        {
+            p *= PeakDecay;
+            p = (p < Pk[samp]) ? Pk[samp] : p;
+            Pk[samp] = p;
+            Max = (Max < p) ? p : Max;
+
+            m += RMSCoef * (Rm[samp] - m);
+            Rm[samp] = m;
+        }
+
+        for (int samp = 0; samp < Samples; samp++) Rm[samp] = sqrtf(Rm[samp]);
+
+        *P = p;
+        *M = m;
+        return Max;
+    }
+
+    //R1.01 SINGLE BAND COMPRESSOR. Same math as the original per sample compressor.
+    static void Comp(float* Data, const float* Level, int Samples, const MakoKernels::tp_comp& C, float* Gain, float* Adj)
+    {
+        float g = *Gain;
+        float a = *Adj;
+
+        for (int samp = 0; samp < Samples; samp++)
+        {
+            float tSa = Level[samp];
+            if (C.Thresh < tSa)
+            {
+                //R1.00 Calc what our new gain reduction value should be, then move towards it.
+                g = (C.Thresh + ((tSa - C.Thresh) * C.Ratio)) / tSa;
+                if (g < a)
+                {
+                    a -= C.Attack;
+                    if (a < 0.0f) a = 0.0f;
+                }
+                else
+                {
+                    a += C.Release;
+                    if (1.0f < a) a = 1.0f;
+                }
+            }
+            else
+            {
+                a += C.Release;
+                if (1.0f < a) a = 1.0f;
+            }
+            Data[samp] *= a;
+        }
+
+        *Gain = g;
+        *Adj = a;
+    }
+
+    //R1.01 MULTIBAND COMPRESSOR. Lanes is 4 (one channel, Ch) or 8 (both channels side by side).
+    //R1.01 Coefficients and compressor settings are widened to every lane and the state is copied into
+    //R1.01 locals first, so each inner loop is one straight vector op with nothing the compiler has to reload.
+    template <int Lanes>
+    static void MultiBand_Lanes(float* const* Data, int Ch, int Samples, MakoKernels::tp_lanefilter* F, float (*Env)[4], float (*Adj)[4], const MakoKernels::tp_comp* C)
+    {
+        const int S = MakoKernels::MB_Stages;
+        alignas(64) float a0[S][Lanes], a1[S][Lanes], a2[S][Lanes], b1[S][Lanes], b2[S][Lanes];
+        alignas(64) float x1[S][Lanes], x2[S][Lanes], y1[S][Lanes], y2[S][Lanes];
+        alignas(64) float En[Lanes], Ad[Lanes];
+        alignas(64) float Th[Lanes], Ra[Lanes], At[Lanes], Re[Lanes], Pd[Lanes];
+        alignas(64) float v[Lanes];
+
+        //R1.01 Lane k is channel Ch + k / 4, band k % 4.
+        for (int f = 0; f < S; f++)
+        {
+            for (int k = 0; k < Lanes; k++)
+            {
+                int c = Ch + (k >> 2);
+                a0[f][k] = F[f].a0[k & 3];
+                a1[f][k] = F[f].a1[k & 3];
+                a2[f][k] = F[f].a2[k & 3];
+                b1[f][k] = F[f].b1[k & 3];
+                b2[f][k] = F[f].b2[k & 3];
+                x1[f][k] = F[f].xn1[c][k & 3];
+                x2[f][k] = F[f].xn2[c][k & 3];
+                y1[f][k] = F[f].yn1[c][k & 3];
+                y2[f][k] = F[f].yn2[c][k & 3];
+            }
+        }
+        for (int k = 0; k < Lanes; k++)
+        {
+            int c = Ch + (k >> 2);
+            En[k] = Env[c][k & 3];
+            Ad[k] = Adj[c][k & 3];
+            Th[k] = C[c].Thresh;
+            Ra[k] = C[c].Ratio;
+            At[k] = C[c].Attack;
+            Re[k] = C[c].Release;
+            Pd[k] = C[c].PeakDecay;
+        }
+
+        for (int samp = 0; samp < Samples; samp++)
+        {
+            for (int k = 0; k < Lanes; k++) v[k] = Data[Ch + (k >> 2)][samp];
+
+            //R1.01 Band split. Each lane runs its own cascade.
+            for (int f = 0; f < S; f++)
+            {
+                for (int k = 0; k < Lanes; k++)
+                {
+                    float y = a0[f][k] * v[k] + a1[f][k] * x1[f][k] + a2[f][k] * x2[f][k] - b1[f][k] * y1[f][k] - b2[f][k] * y2[f][k];
+                    x2[f][k] = x1[f][k];
+                    x1[f][k] = v[k];
+                    y2[f][k] = y1[f][k];
+                    y1[f][k] = y;
+                    v[k] = y;
+                }
+            }
+
+            //R1.01 Per band peak level and gain. Below the threshold the target gain works out to 1.0.
+            for (int k = 0; k < Lanes; k++)
+            {
+                float a = fabsf(v[k]);
+                float d = En[k] * Pd[k];
+                En[k] = (a < d) ? d : a;
+
+                float e = (En[k] < Th[k]) ? Th[k] : En[k];
+                e = (e < 1.0e-9f) ? 1.0e-9f : e;
+                float Target = (Th[k] + (e - Th[k]) * Ra[k]) / e;
+
+                float g = Ad[k] + ((Target < Ad[k]) ? -At[k] : Re[k]);
+                g = (g < 0.0f) ? 0.0f : g;
+                Ad[k] = (1.0f < g) ? 1.0f : g;
+            }
+
+            for (int ch = 0; ch < Lanes / 4; ch++)
+            {
+                float Sum = 0.0f;
+                for (int b = 0; b < 4; b++) Sum += v[ch * 4 + b] * Ad[ch * 4 + b];
+                Data[Ch + ch][samp] = Sum;
+            }
+        }
+
+        for (int f = 0; f < S; f++)
+        {
+            for (int k = 0; k < Lanes; k++)
+            {
+                int c = Ch + (k >> 2);
+                F[f].xn1[c][k & 3] = x1[f][k];
+                F[f].xn2[c][k & 3] = x2[f][k];
+                F[f].yn1[c][k & 3] = y1[f][k];
+                F[f].yn2[c][k & 3] = y2[f][k];
+            }
+        }
+        for (int k = 0; k < Lanes; k++)
+        {
+            Env[Ch + (k >> 2)][k & 3] = En[k];
+            Adj[Ch + (k >> 2)][k & 3] = Ad[k];
+        }
+    }
+
+    //R1.01 Short blocks from tiny host buffers work on the filter state where it is. Widening the coefficients
+    //R1.01 costs more than filtering a few samples, and the 4 bands of one channel still fill a vector.
+    static void MultiBand_Direct(float* const* Data, int Mask, int Samples, MakoKernels::tp_lanefilter* F, float (*Env)[4], float (*Adj)[4], const MakoKernels::tp_comp* Comp)
+    {
+        const int S = MakoKernels::MB_Stages;
+
+        for (int ch = 0; ch < 2; ch++)
+        {
+            if ((Mask & (1 << ch)) == 0) continue;
+            const MakoKernels::tp_comp& C = Comp[ch];
+            float* cD = Data[ch];
+            float* En = Env[ch];
+            float* Ad = Adj[ch];
+
+            for (int samp = 0; samp < Samples; samp++)
+            {
+                float v[4];
+                for (int b = 0; b < 4; b++) v[b] = cD[samp];
+
+                for (int f = 0; f < S; f++)
+                {
+                    MakoKernels::tp_lanefilter& L = F[f];
+                    for (int b = 0; b < 4; b++)
+                    {
+                        float y = L.a0[b] * v[b] + L.a1[b] * L.xn1[ch][b] + L.a2[b] * L.xn2[ch][b] - L.b1[b] * L.yn1[ch][b] - L.b2[b] * L.yn2[ch][b];
+                        L.xn2[ch][b] = L.xn1[ch][b];
+                        L.xn1[ch][b] = v[b];
+                        L.yn2[ch][b] = L.yn1[ch][b];
+                        L.yn1[ch][b] = y;
+                        v[b] = y;
+                    }
+                }
+
+                for (int b = 0; b < 4; b++)
+                {
+                    float a = fabsf(v[b]);
+                    float d = En[b] * C.PeakDecay;
+                    En[b] = (a < d) ? d : a;
+
+                    float e = (En[b] < C.Thresh) ? C.Thresh : En[b];
+                    e = (e < 1.0e-9f) ? 1.0e-9f : e;
+                    float Target = (C.Thresh + (e - C.Thresh) * C.Ratio) / e;
+
+                    float g = Ad[b] + ((Target < Ad[b]) ? -C.Attack : C.Release);
+                    g = (g < 0.0f) ? 0.0f : g;
+                    Ad[b] = (1.0f < g) ? 1.0f : g;
+                }
+
+                float Sum = 0.0f;
+                for (int b = 0; b < 4; b++) Sum += v[b] * Ad[b];
+                cD[samp] = Sum;
+            }
+        }
+    }
+
+    //R1.01 DYNAMIC EQ.
+    //R1.01 * The band pass detectors of all bands (and both channels) run side by side, one lane each.
+    //R1.01 * The three EQ filters run in series, both channels side by side, with a0 and a2 moving in a
+    //R1.01   straight line towards the last gains worked out.
+    //R1.01 * Every Dyn_Step samples new gains are worked out from the envelopes, one lane per band,
+    //R1.01   and the EQ filters get new steps to reach them over the next Dyn_Step samples.
+    template <int Ch>
+    static void DynEQ_Run(float* const* Data, int Samples, MakoKernels::tp_filter* const* Band, const MakoKernels::tp_dynset& D, MakoKernels::tp_dynstate* S)
+    {
+        const int Lanes = Ch * 4;
+        const int Step = MakoKernels::Dyn_Step;
+        alignas(32) float da0[Lanes], db1[Lanes], db2[Lanes], At[Lanes], Re[Lanes], Th[Lanes], Sl[Lanes], St[Lanes], C0[Lanes], C1[Lanes];
+        alignas(32) float x1[Lanes], x2[Lanes], y1[Lanes], y2[Lanes], En[Lanes], v[Lanes], V[Lanes];
+        float a0[3][Ch], a1[3][Ch], a2[3][Ch], b1[3][Ch], b2[3][Ch];
+        float ex1[3][Ch], ex2[3][Ch], ey1[3][Ch], ey2[3][Ch];
+        float d0[3][Ch], d2[3][Ch];
+
+        //R1.01 Lane k is channel k / 4, band k % 4.
+        for (int k = 0; k < Lanes; k++)
+        {
+            int c = k >> 2, b = k & 3;
+            da0[k] = D.d_a0[b]; db1[k] = D.d_b1[b]; db2[k] = D.d_b2[b];
+            At[k] = D.Attack[b]; Re[k] = D.Release[b];
+            Th[k] = D.Thresh[b]; Sl[k] = D.Slope[b]; St[k] = D.Static[c][b];
+            C0[k] = D.C0[b]; C1[k] = D.C1[b];
+            x1[k] = S->x1[c][b]; x2[k] = S->x2[c][b];
+            y1[k] = S->y1[c][b]; y2[k] = S->y2[c][b];
+            En[k] = S->Env[c][b];
+        }
+        for (int b = 0; b < 3; b++)
+        {
+            for (int c = 0; c < Ch; c++)
+            {
+                a0[b][c] = Band[b]->a0[c]; a1[b][c] = Band[b]->a1[c]; a2[b][c] = Band[b]->a2[c];
+                b1[b][c] = Band[b]->b1[c]; b2[b][c] = Band[b]->b2[c];
+                ex1[b][c] = Band[b]->xn1[c]; ex2[b][c] = Band[b]->xn2[c];
+                ey1[b][c] = Band[b]->yn1[c]; ey2[b][c] = Band[b]->yn2[c];
+                d0[b][c] = S->Step0[c][b]; d2[b][c] = S->Step2[c][b];
+            }
+        }
+
+        int Phase = S->Phase;
+        for (int Start = 0; Start < Samples;)
+        {
+            int Count = (Samples - Start < Step - Phase) ? Samples - Start : Step - Phase;
+
+            //R1.01 Detect. Band pass, then a peak envelope with its own attack and release.
+            for (int samp = Start; samp < Start + Count; samp++)
+            {
+                for (int k = 0; k < Lanes; k++) v[k] = Data[k >> 2][samp];
+                for (int k = 0; k < Lanes; k++)
+                {
+                    float y = da0[k] * (v[k] - x2[k]) - db1[k] * y1[k] - db2[k] * y2[k];
+                    x2[k] = x1[k]; x1[k] = v[k];
+                    y2[k] = y1[k]; y1[k] = y;
+                    float a = fabsf(y);
+                    En[k] += ((En[k] < a) ? At[k] : Re[k]) * (a - En[k]);
+                }
+            }
+
+            //R1.01 EQ. Same biquad math as the static EQ.
+            for (int samp = Start; samp < Start + Count; samp++)
+            {
+                float x[Ch];
+                for (int c = 0; c < Ch; c++) x[c] = Data[c][samp];
+                for (int b = 0; b < 3; b++)
+                {
+                    for (int c = 0; c < Ch; c++)
+                    {
+                        a0[b][c] += d0[b][c];
+                        a2[b][c] += d2[b][c];
+                        float y = a0[b][c] * x[c] + a1[b][c] * ex1[b][c] + a2[b][c] * ex2[b][c] - b1[b][c] * ey1[b][c] - b2[b][c] * ey2[b][c];
+                        ex2[b][c] = ex1[b][c]; ex1[b][c] = x[c];
+                        ey2[b][c] = ey1[b][c]; ey1[b][c] = y;
+                        x[c] = y;
+                    }
+                }
+                for (int c = 0; c < Ch; c++) Data[c][samp] = x[c];
+            }
+
+            Start += Count;
+            Phase += Count;
+            if (Phase < Step) break;
+            Phase = 0;
+
+            //R1.01 New band gains. 6.0206 dB per doubling.
+            for (int k = 0; k < Lanes; k++)
+            {
+                float e = (En[k] < 1.0e-9f) ? 1.0e-9f : En[k];
+                float Over = Mako_FastLog2(e) * 6.0206f - Th[k];
+                Over = (Over < 0.0f) ? 0.0f : Over;
+                float dB = St[k] - Over * Sl[k];
+                dB = (dB < -12.0f) ? -12.0f : dB;
+                dB = (12.0f < dB) ? 12.0f : dB;
+                V[k] = Mako_FastExp2(dB * .16609640f);
+            }
+
+            for (int b = 0; b < 3; b++)
+            {
+                for (int c = 0; c < Ch; c++)
+                {
+                    int k = c * 4 + b;
+                    d0[b][c] = (C0[k] + V[k] * C1[k] - a0[b][c]) * (1.0f / float(Step));
+                    d2[b][c] = (C0[k] - V[k] * C1[k] - a2[b][c]) * (1.0f / float(Step));
+                }
+            }
+        }
+        S->Phase = Phase;
+
+        for (int k = 0; k < Lanes; k++)
+        {
+            int c = k >> 2, b = k & 3;
+            S->x1[c][b] = x1[k]; S->x2[c][b] = x2[k];
+            S->y1[c][b] = y1[k]; S->y2[c][b] = y2[k];
+            S->Env[c][b] = En[k];
+        }
+        for (int b = 0; b < 3; b++)
+        {
+            for (int c = 0; c < Ch; c++)
+            {
+                S->Step0[c][b] = d0[b][c]; S->Step2[c][b] = d2[b][c];
+                Band[b]->a0[c] = a0[b][c]; Band[b]->a2[c] = a2[b][c];
+                Band[b]->xn0[c] = ex1[b][c];
+                Band[b]->xn1[c] = ex1[b][c]; Band[b]->xn2[c] = ex2[b][c];
+                Band[b]->yn1[c] = ey1[b][c]; Band[b]->yn2[c] = ey2[b][c];
+            }
+        }
+    }
+
+    static void DynEQ(float* const* Data, int Channels, int Samples, MakoKernels::tp_filter* const* Band, const MakoKernels::tp_dynset& D, MakoKernels::tp_dynstate* S)
+    {
+        if (Samples <= 0) return;
+        if (Channels < 2)
+            DynEQ_Run<1>(Data, Samples, Band, D, S);
+        else
+            DynEQ_Run<2>(Data, Samples, Band, D, S);
+    }
+
+    static void MultiBand(float* const* Data, int Mask, int Samples, MakoKernels::tp_lanefilter* F, float (*Env)[4], float (*Adj)[4], const MakoKernels::tp_comp* C)
+    {
+        if (Samples < MakoKernels::MB_Short)
+            MultiBand_Direct(Data, Mask, Samples, F, Env, Adj, C);
+        else if (Mask == 3)
+            MultiBand_Lanes<8>(Data, 0, Samples, F, Env, Adj, C);
+        else if (Mask != 0)
+            MultiBand_Lanes<4>(Data, Mask >> 1, Samples, F, Env, Adj, C);
+    }
+}
+
+//R1.01 The table for this instruction set, looked up by MakoKernels::Get.
+extern const MakoKernels::tp_table MAKO_KERNEL_TABLE;
+const MakoKernels::tp_table MAKO_KERNEL_TABLE = {
+    MAKO_KERNEL_NAME,
+    MAKO_KERNEL_PATH,
+    &MAKO_KERNEL_NS::BiQuad,
+    &MAKO_KERNEL_NS::BiQuad2,
+    &MAKO_KERNEL_NS::Gate,
+    &MAKO_KERNEL_NS::Drive,
+    &MAKO_KERNEL_NS::DriveAA,
+    &MAKO_KERNEL_NS::Detect,
+    &MAKO_KERNEL_NS::Comp,
+    &MAKO_KERNEL_NS::MultiBand,
+    &MAKO_KERNEL_NS::DynEQ,
+};
@@ -0,0 +1,43 @@
+/*
+  ==============================================================================
+
+    MakoKernels_AVX2.cpp
+    R1.01 The kernels built for AVX2 + FMA. See MakoKernels.h.
+
+    GCC and Clang switch the instruction set for this file themselves.
+    Visual C++ needs it set for this file only: Properties > C/C++ >
+    Code Generation > Enable Enhanced Instruction Set > AVX2 (/arch:AVX2).
+    Never set it for the whole project, the base kernels must run anywhere.
+
+  ==============================================================================
+*/
+
+#include "MakoKernels.h"
+
+#if MAKO_KERNELS_X86
+
+#if defined(_MSC_VER) && !defined(__clang__) && !defined(__AVX2__)
+ #pragma message("MakoKernels_AVX2.cpp: set /arch:AVX2 for this file, the AVX2 kernels are built as SSE2.")
+#endif
+
+//R1.01 Everything below is built for AVX2. The headers above keep their normal settings.
+#if defined(__clang__)
+ #pragma clang attribute push (__attribute__((target("avx2,fma"))), apply_to = function)
+#elif defined(__GNUC__)
+ #pragma GCC push_options
+ #pragma GCC target("avx2,fma")
+#endif
+
+#define MAKO_KERNEL_NS      Mako_Kernels_AVX2
+#define MAKO_KERNEL_TABLE   Mako_Kernels_AVX2_Table
+#define MAKO_KERNEL_NAME    "AVX2"
+#define MAKO_KERNEL_PATH    MakoKernels::e_Path_AVX2
+#include "MakoKernelsImpl.h"
+
+#if defined(__clang__)
+ #pragma clang attribute pop
+#elif defined(__GNUC__)
+ #pragma GCC pop_options
+#endif
+
+#endif
@@ -0,0 +1,117 @@
+/*
+  ==============================================================================
+
+    MakoLimiter.cpp
+    R1.01 Lookahead brickwall limiter. See MakoLimiter.h.
+
+  ==============================================================================
+*/
+
+#include "MakoLimiter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+void MakoLimiter::Prepare(int NewAhead, float SampleRate)
+{
+    Ahead = std::max(0, std::min(Ahead_Max, NewAhead));
+
+    //R1.01 50 mS release.
+    Release = 1.0f - expf(-1.0f / (.050f * SampleRate));
+    Gain = 1.0f;
+
+    Q_First = 0;
+    Q_Count = 0;
+    Pos = 0;
+    for (int t = 0; t < Ahead_Max; t++) Box[t] = 1.0f;
+    Box_Sum = double(Ahead);
+    Box_Pos = 0;
+    Box_Scale = (0 < Ahead) ? 1.0f / float(Ahead) : 1.0f;
+
+    memset(Delay, 0, sizeof(Delay));
+    Delay_Write = 0;
+    TruePeak.Reset();
+}
+
+//R1.01 The gain applied at sample n is the average of the held minimum over the last Ahead samples,
+//R1.01 each of which covers the Ahead samples before it. Only the needed gain Ahead - 1 samples back
+//R1.01 is in every one of them, so the output is delayed by that much (plus the true peak filter delay)
+//R1.01 and the gain is never above what that sample needs.
+void MakoLimiter::Process(float* const* Data, int Channels, int Samples)
+{
+    if (Ahead <= 0) return;
+
+    const int Lag = Latency(Ahead);
+    float Env[Chunk];
+    float Env2[Chunk];
+
+    for (int Start = 0; Start < Samples; Start += Chunk)
+    {
+        int n = std::min(Chunk, Samples - Start);
+
+        //R1.01 Linked detection, the louder channel sets the gain.
+        TruePeak.Envelope(0, Data[0] + Start, Env, n);
+        if (1 < Channels)
+        {
+            TruePeak.Envelope(1, Data[1] + Start, Env2, n);
+            for (int i = 0; i < n; i++) Env[i] = std::max(Env[i], Env2[i]);
+        }
+
+        for (int i = 0; i < n; i++)
+        {
+            //R1.01 The sample itself counts too, the filter rounds off single sample spikes.
+            float Peak = Env[i];
+            int Near = (Delay_Write - MakoTruePeak::Delay) & (Delay_Size - 1);
+            for (int channel = 0; channel < Channels; channel++) Peak = std::max(Peak, std::fabs(Delay[channel][Near]));
+            float Need = (Ceiling < Peak) ? Ceiling / Peak : 1.0f;
+
+            //R1.01 Sliding window minimum. Drop the oldest gain once it leaves the window, and anything
+            //R1.01 at or above the new gain since it can never be the lowest again.
+            if ((0 < Q_Count) && (Q_Pos[Q_First] <= Pos - Ahead))
+            {
+                Q_First = (Q_First + 1) & (Ahead_Max - 1);
+                Q_Count--;
+            }
+            while ((0 < Q_Count) && (Need <= Q_Gain[(Q_First + Q_Count - 1) & (Ahead_Max - 1)])) Q_Count--;
+            Q_Pos[(Q_First + Q_Count) & (Ahead_Max - 1)] = Pos;
+            Q_Gain[(Q_First + Q_Count) & (Ahead_Max - 1)] = Need;
+            Q_Count++;
+            float Hold = Q_Gain[Q_First];
+
+            //R1.01 Average over the window.
+            Box_Sum += double(Hold) - double(Box[Box_Pos]);
+            Box[Box_Pos] = Hold;
+            if (++Box_Pos == Ahead) Box_Pos = 0;
+            float Target = float(Box_Sum) * Box_Scale;
+
+            //R1.01 Down at once (the average is already smooth), back up with the release.
+            if (Target < Gain)
+                Gain = Target;
+            else
+                Gain += (Target - Gain) * Release;
+
+            int Read = (Delay_Write - Lag) & (Delay_Size - 1);
+            for (int channel = 0; channel < Channels; channel++)
+            {
+                float* cD = Data[channel] + Start;
+                Delay[channel][Delay_Write] = cD[i];
+                cD[i] = Delay[channel][Read] * Gain;
+            }
+            Delay_Write = (Delay_Write + 1) & (Delay_Size - 1);
+
+            //R1.01 Keep the counter small, only the differences matter.
+            if (++Pos == (1 << 30))
+            {
+                Pos -= (1 << 30);
+                for (int q = 0; q < Q_Count; q++) Q_Pos[(Q_First + q) & (Ahead_Max - 1)] -= (1 << 30);
+            }
+        }
+    }
+}
+
+void MakoLimiter::CopyChannel(int From, int To)
+{
+    memcpy(Delay[To], Delay[From], sizeof(Delay[0]));
+    TruePeak.CopyChannel(From, To);
+}
@@ -0,0 +1,74 @@
+/*
+  ==============================================================================
+
+    MakoLimiter.h
+    R1.01 Lookahead brickwall LIMITER for the output.
+
+    Detection uses the true peak envelope (4x oversampled), so overs between
+    samples are caught too. For each sample the gain needed to stay under the
+    ceiling is worked out, then:
+    * The lowest needed gain over the lookahead window is held. This is a
+      sliding window minimum using a monotonic queue, O(1) per sample.
+    * The held gain is averaged over the same window, so the gain ramps down
+      smoothly and reaches the needed value as the peak comes out of the delay.
+    * Gain comes back up with a one pole release.
+    Both channels get the same gain so the stereo image does not move.
+
+    Latency is the lookahead plus the true peak filter delay, see Latency().
+    Everything is fixed size, Prepare never allocates.
+
+    Plain C++, no JUCE needed.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "MakoTruePeak.h"
+
+class MakoLimiter
+{
+public:
+    static constexpr int Ahead_Max = 1024;  //R1.01 Over 5 mS at 192k.
+
+    //R1.01 Set the lookahead in samples (0 turns the limiter off) and start over. Never allocates.
+    void Prepare(int Ahead, float SampleRate);
+    int GetAhead() const { return Ahead; }
+
+    //R1.01 Samples of delay for a lookahead, so the host can be told before the audio thread changes over.
+    static int Latency(int Ahead) { return (0 < Ahead) ? Ahead - 1 + MakoTruePeak::Delay : 0; }
+
+    //R1.01 Audio thread. Limit the block in place.
+    void Process(float* const* Data, int Channels, int Samples);
+
+    //R1.01 Let one channel carry on where another one is (leaving mono mode).
+    void CopyChannel(int From, int To);
+
+private:
+    static constexpr int Chunk = 256;
+    static constexpr int Delay_Size = 2048;  //R1.01 Power of 2, over Ahead_Max + MakoTruePeak::Delay.
+    const float Ceiling = .977f;         //R1.01 -0.2 dBTP, leaves a little room for the true peak estimate.
+
+    int Ahead = 0;
+    float Release = 0.0f;
+    float Gain = 1.0f;
+
+    //R1.01 Sliding window minimum. Needed gains waiting to be the lowest, oldest first and rising.
+    //R1.01 A ring of Ahead_Max (power of 2), there are never more than Ahead in it.
+    int Q_Pos[Ahead_Max] = {};
+    float Q_Gain[Ahead_Max] = {};
+    int Q_First = 0;
+    int Q_Count = 0;
+    int Pos = 0;
+
+    //R1.01 Running average of the held gain.
+    float Box[Ahead_Max] = {};
+    double Box_Sum = 0.0;
+    int Box_Pos = 0;
+    float Box_Scale = 1.0f;
+
+    float Delay[2][Delay_Size] = {};
+    int Delay_Write = 0;
+
+    MakoTruePeak TruePeak;
+};
@@ -0,0 +1,154 @@
+/*
+  ==============================================================================
+
+    MakoTrace.cpp
+    R1.01 Per thread trace rings and the background thread that dumps them.
+
+  ==============================================================================
+*/
+
+#include "MakoTrace.h"
+
+#if MAKO_TRACE
+
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+
+namespace MakoTrace
+{
+    //R1.01 One finished marker.
+    struct tp_event {
+        const char* Name;
+        int64_t Begin;
+        int64_t End;
+    };
+
+    //R1.01 Single producer (the owning thread), single consumer (the dump thread) ring.
+    //R1.01 Rings are claimed from a fixed pool the first time a thread writes, so the
+    //R1.01 audio thread never allocates.
+    const int Ring_Size = 4096;
+    const int Ring_Count = 32;
+
+    struct tp_ring {
+        std::atomic<bool> InUse{ false };
+        std::atomic<uint32_t> Head{ 0 };     //R1.01 Written by the owning thread.
+        std::atomic<uint32_t> Tail{ 0 };     //R1.01 Written by the dump thread.
+        uint32_t ThreadID = 0;
+        tp_event Events[Ring_Size];
+    };
+
+    static tp_ring Rings[Ring_Count];
+    static thread_local tp_ring* MyRing = nullptr;
+    static thread_local bool MyRingFailed = false;
+
+    //R1.01 Dump thread state. Only touched by Start/Stop and the dump thread itself.
+    static std::mutex Dump_Lock;
+    static std::condition_variable Dump_Wake;
+    static std::thread Dump_Thread;
+    static int Dump_Users = 0;
+    static bool Dump_Quit = false;
+    static const int64_t Epoch = Now();
+
+    static tp_ring* Claim_Ring()
+    {
+        for (int t = 0; t < Ring_Count; t++)
+        {
+            bool Expected = false;
+            if (Rings[t].InUse.compare_exchange_strong(Expected, true))
+            {
+                Rings[t].ThreadID = uint32_t(t + 1);
+                return &Rings[t];
+            }
+        }
+        return nullptr;
+    }
+
+    void Write(const char* Name, int64_t Begin, int64_t End)
+    {
+        if (MyRing == nullptr)
+        {
+            if (MyRingFailed) return;
+            MyRing = Claim_Ring();
+            if (MyRing == nullptr) { MyRingFailed = true; return; }
+        }
+
+        uint32_t Head = MyRing->Head.load(std::memory_order_relaxed);
+        if (Head - MyRing->Tail.load(std::memory_order_acquire) >= uint32_t(Ring_Size)) return;
+
+        MyRing->Events[Head % Ring_Size] = { Name, Begin, End };
+        MyRing->Head.store(Head + 1, std::memory_order_release);
+    }
+
+    //R1.01 Empty every ring into the JSON file. Chrome accepts the array without a closing bracket,
+    //R1.01 so a trace that ends with a crash or a killed host can still be opened.
+    static void Dump_Rings(FILE* File, bool& First)
+    {
+        for (int r = 0; r < Ring_Count; r++)
+        {
+            tp_ring& Ring = Rings[r];
+            if (!Ring.InUse.load(std::memory_order_acquire)) continue;
+
+            uint32_t Tail = Ring.Tail.load(std::memory_order_relaxed);
+            uint32_t Head = Ring.Head.load(std::memory_order_acquire);
+            while (Tail != Head)
+            {
+                const tp_event& E = Ring.Events[Tail % Ring_Size];
+                std::fprintf(File, "%s{\"name\":\"%s\",\"cat\":\"mako\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+                    First ? "[\n" : ",\n", E.Name, (E.Begin - Epoch) * .001, (E.End - E.Begin) * .001, Ring.ThreadID);
+                First = false;
+                Tail++;
+            }
+            Ring.Tail.store(Tail, std::memory_order_release);
+        }
+        std::fflush(File);
+    }
+
+    static void Dump_Run()
+    {
+        const char* Env = std::getenv("MAKO_TRACE_FILE");
+        std::string Path = (Env != nullptr) ? std::string(Env) : (std::filesystem::temp_directory_path() / "MakoPrecog_trace.json").string();
+        FILE* File = std::fopen(Path.c_str(), "w");
+        bool First = true;
+        if (File == nullptr) return;
+
+        std::unique_lock<std::mutex> Lock(Dump_Lock);
+        while (!Dump_Quit)
+        {
+            Dump_Wake.wait_for(Lock, std::chrono::milliseconds(100));
+            Dump_Rings(File, First);
+        }
+
+        Dump_Rings(File, First);
+        std::fprintf(File, First ? "[]\n" : "\n]\n");
+        std::fclose(File);
+    }
+
+    void Start()
+    {
+        std::lock_guard<std::mutex> Lock(Dump_Lock);
+        if (Dump_Users++ == 0)
+        {
+            Dump_Quit = false;
+            Dump_Thread = std::thread(Dump_Run);
+        }
+    }
+
+    void Stop()
+    {
+        std::thread Done;
+        {
+            std::lock_guard<std::mutex> Lock(Dump_Lock);
+            if ((Dump_Users == 0) || (--Dump_Users != 0)) return;
+            Dump_Quit = true;
+            Done = std::move(Dump_Thread);
+        }
+        Dump_Wake.notify_all();
+        if (Done.joinable()) Done.join();
+    }
+}
+
+#endif
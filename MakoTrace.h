@@ -0,0 +1,69 @@
+/*
+  ==============================================================================
+
+    MakoTrace.h
+    R1.01 Scoped trace markers for finding which stage of processBlock is spiking.
+
+    Build with MAKO_TRACE=1 to turn them on. Each marker writes a begin and end
+    timestamp into a lock free ring buffer owned by the calling thread. A background
+    thread empties the rings into a Chrome trace-event JSON file (open it in
+    chrome://tracing or https://ui.perfetto.dev).
+
+    The file goes to MAKO_TRACE_FILE if set, or MakoPrecog_trace.json in the temp folder.
+
+    With MAKO_TRACE off the markers compile to nothing.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#ifndef MAKO_TRACE
+ #define MAKO_TRACE 0
+#endif
+
+#if MAKO_TRACE
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace MakoTrace
+{
+    //R1.01 Timestamps are steady clock nanoseconds.
+    inline int64_t Now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    //R1.01 Store one finished marker. Never allocates, never locks. Drops the event if the ring is full.
+    void Write(const char* Name, int64_t Begin, int64_t End);
+
+    //R1.01 Each plugin instance calls Start/Stop. The dump thread runs while anyone needs it.
+    void Start();
+    void Stop();
+
+    //R1.01 Marks the time from construction to the end of the scope.
+    struct Scope
+    {
+        const char* Name;
+        int64_t Begin;
+
+        explicit Scope(const char* n) : Name(n), Begin(Now()) {}
+        ~Scope() { Write(Name, Begin, Now()); }
+    };
+}
+
+#define MAKO_TRACE_JOIN2(a, b) a##b
+#define MAKO_TRACE_JOIN(a, b) MAKO_TRACE_JOIN2(a, b)
+#define MAKO_TRACE_SCOPE(Name) MakoTrace::Scope MAKO_TRACE_JOIN(MakoTraceScope_, __LINE__) (Name)
+#define MAKO_TRACE_START() MakoTrace::Start()
+#define MAKO_TRACE_STOP() MakoTrace::Stop()
+
+#else
+
+#define MAKO_TRACE_SCOPE(Name)
+#define MAKO_TRACE_START()
+#define MAKO_TRACE_STOP()
+
+#endif
@@ -0,0 +1,110 @@
+/*
+  ==============================================================================
+
+    MakoTruePeak.cpp
+    R1.01 True peak meter kernel. See MakoTruePeak.h.
+
+  ==============================================================================
+*/
+
+#include "MakoTruePeak.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+//R1.01 The 4x interpolation filter from ITU-R BS.1770 Annex 2, one row per phase.
+static const float TP_Phase[4][12] = {
+    {  0.0017089843750f,  0.0109863281250f, -0.0196533203125f,  0.0332031250000f, -0.0594482421875f,  0.1373291015625f,
+       0.9721679687500f, -0.1022949218750f,  0.0476074218750f, -0.0266113281250f,  0.0148925781250f, -0.0083007812500f },
+    { -0.0291748046875f,  0.0292968750000f, -0.0517578125000f,  0.0891113281250f, -0.1665039062500f,  0.4650878906250f,
+       0.7797851562500f, -0.2003173828125f,  0.1015625000000f, -0.0582275390625f,  0.0330810546875f, -0.0189208984375f },
+    { -0.0189208984375f,  0.0330810546875f, -0.0582275390625f,  0.1015625000000f, -0.2003173828125f,  0.7797851562500f,
+       0.4650878906250f, -0.1665039062500f,  0.0891113281250f, -0.0517578125000f,  0.0292968750000f, -0.0291748046875f },
+    { -0.0083007812500f,  0.0148925781250f, -0.0266113281250f,  0.0476074218750f, -0.1022949218750f,  0.9721679687500f,
+       0.1373291015625f, -0.0594482421875f,  0.0332031250000f, -0.0196533203125f,  0.0109863281250f,  0.0017089843750f },
+};
+
+//R1.01 Highest absolute value, with 8 running maximums so the compiler can vectorize it.
+static float TP_AbsMax(const float* y, int N)
+{
+    float m[8] = {};
+    int i = 0;
+    for (; i + 8 <= N; i += 8)
+        for (int k = 0; k < 8; k++) m[k] = std::max(m[k], std::fabs(y[i + k]));
+    for (; i < N; i++) m[0] = std::max(m[0], std::fabs(y[i]));
+
+    return std::max(std::max(std::max(m[0], m[1]), std::max(m[2], m[3])), std::max(std::max(m[4], m[5]), std::max(m[6], m[7])));
+}
+
+//R1.01 Run one phase of the interpolation filter over a block. Phase output i = sum over k of
+//R1.01 TP_Phase[p][k] * x[i - k], where x has Taps - 1 samples of history in front of it.
+//R1.01 The tap loop is fixed length so it unrolls, and the sample loop vectorizes with the sums kept in registers.
+static void TP_Filter(const float* x, int p, float* y, int n)
+{
+    const float* c = TP_Phase[p];
+    for (int i = 0; i < n; i++)
+    {
+        float Sum = 0.0f;
+        for (int k = 0; k < 12; k++) Sum += c[k] * x[i + 11 - k];
+        y[i] = Sum;
+    }
+}
+
+void MakoTruePeak::Reset()
+{
+    memset(Hist, 0, sizeof(Hist));
+}
+
+void MakoTruePeak::CopyChannel(int From, int To)
+{
+    memcpy(Hist[To], Hist[From], sizeof(Hist[0]));
+}
+
+//R1.01 The last Taps - 1 input samples are kept in front of the block so every output has its full history.
+float MakoTruePeak::Process(int Channel, const float* Data, int Samples)
+{
+    float x[Taps - 1 + Chunk];
+    float y[Chunk];
+    float Peak = 0.0f;
+
+    for (int Start = 0; Start < Samples; Start += Chunk)
+    {
+        int n = std::min(Chunk, Samples - Start);
+        memcpy(x, Hist[Channel], sizeof(Hist[0]));
+        memcpy(x + Taps - 1, Data + Start, sizeof(float) * size_t(n));
+
+        for (int p = 0; p < 4; p++)
+        {
+            TP_Filter(x, p, y, n);
+            Peak = std::max(Peak, TP_AbsMax(y, n));
+        }
+
+        memcpy(Hist[Channel], x + n, sizeof(Hist[0]));
+    }
+
+    return Peak;
+}
+
+void MakoTruePeak::Envelope(int Channel, const float* Data, float* Out, int Samples)
+{
+    float x[Taps - 1 + Chunk];
+    float y[Chunk];
+
+    for (int Start = 0; Start < Samples; Start += Chunk)
+    {
+        int n = std::min(Chunk, Samples - Start);
+        float* o = Out + Start;
+        memcpy(x, Hist[Channel], sizeof(Hist[0]));
+        memcpy(x + Taps - 1, Data + Start, sizeof(float) * size_t(n));
+
+        memset(o, 0, sizeof(float) * size_t(n));
+        for (int p = 0; p < 4; p++)
+        {
+            TP_Filter(x, p, y, n);
+            for (int i = 0; i < n; i++) o[i] = std::max(o[i], std::fabs(y[i]));
+        }
+
+        memcpy(Hist[Channel], x + n, sizeof(Hist[0]));
+    }
+}
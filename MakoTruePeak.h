@@ -0,0 +1,40 @@
+/*
+  ==============================================================================
+
+    MakoTruePeak.h
+    R1.01 TRUE PEAK (intersample) detection for the output meters.
+
+    ITU-R BS.1770 style: the signal is upsampled 4x with the 48 tap polyphase
+    FIR from the standard, and the highest upsampled value is the true peak.
+    Each phase is run over the whole block with the 12 taps unrolled, so the
+    compiler vectorizes across samples. About 48 multiply-adds per sample.
+
+    Plain C++, no JUCE needed.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+class MakoTruePeak
+{
+public:
+    //R1.01 Forget the filter history (new sample rate, or metering was paused).
+    void Reset();
+
+    //R1.01 Audio thread. Returns the highest absolute upsampled value in the block.
+    float Process(int Channel, const float* Data, int Samples);
+
+    //R1.01 Audio thread. Per sample true peak envelope: Out[i] is the highest absolute value of the
+    //R1.01 4 upsampled phases at input sample i. The filter delays it by about Delay samples.
+    void Envelope(int Channel, const float* Data, float* Out, int Samples);
+    static constexpr int Delay = 6;
+
+    //R1.01 Let one channel carry on where another one is (leaving mono mode).
+    void CopyChannel(int From, int To);
+
+private:
+    static constexpr int Taps = 12;         //R1.01 Per phase.
+    static constexpr int Chunk = 256;       //R1.01 Samples per pass, so our work buffers are fixed size.
+    float Hist[2][Taps - 1] = {};
+};
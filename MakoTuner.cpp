@@ -0,0 +1,229 @@
+/*
+  ==============================================================================
+
+    MakoTuner.cpp
+    R1.01 Built in guitar tuner. See MakoTuner.h.
+
+  ==============================================================================
+*/
+
+#include "MakoTuner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+//R1.01 YIN settings, in decimated samples. 50 Hz - 1400 Hz covers 7 string and baritone guitars
+//R1.01 up to the 24th fret. A new estimate is made every Yin_Hop samples (about 20 mS).
+static const int Yin_Window = 1024;
+static const int Yin_TauMax = 512;
+static const int Yin_Hop = 256;
+static const int Yin_Size = Yin_Window + Yin_TauMax + 2;
+static const float Yin_Threshold = .15f;
+
+//R1.01 Dot product with 8 running sums so the compiler can vectorize it without fast math.
+static float Yin_Dot(const float* a, const float* b, int N)
+{
+    float s[8] = {};
+    int i = 0;
+    for (; i + 8 <= N; i += 8)
+        for (int k = 0; k < 8; k++) s[k] += a[i + k] * b[i + k];
+    for (; i < N; i++) s[0] += a[i] * b[i];
+
+    return ((s[0] + s[1]) + (s[2] + s[3])) + ((s[4] + s[5]) + (s[6] + s[7]));
+}
+
+//R1.01 YIN pitch detector. Returns the pitch in Hz or 0 if there is no clear note.
+//R1.01 The difference function is worked out from dot products: d(tau) = E(0) + E(tau) - 2 r(tau).
+static float Yin_Detect(const float* x, float Fs)
+{
+    const int W = Yin_Window;
+    int TauMin = std::max(2, int(Fs / 1400.0f));
+    int TauMax = std::min(Yin_TauMax, int(Fs / 50.0f));
+
+    //R1.01 Too quiet to tune (about -60 dB).
+    float E0 = Yin_Dot(x, x, W);
+    if (E0 < 1e-6f * W) return 0.0f;
+
+    float Raw[Yin_TauMax + 2];
+    float d[Yin_TauMax + 2];
+    float Et = E0;
+    float Sum = 0.0f;
+    Raw[0] = 0.0f;
+    d[0] = 1.0f;
+    for (int tau = 1; tau <= TauMax + 1; tau++)
+    {
+        Et += x[tau + W - 1] * x[tau + W - 1] - x[tau - 1] * x[tau - 1];
+        float Diff = std::max(0.0f, E0 + Et - 2.0f * Yin_Dot(x, x + tau, W));
+        Raw[tau] = Diff;
+
+        //R1.01 Cumulative mean normalized difference.
+        Sum += Diff;
+        d[tau] = (0.0f < Sum) ? Diff * tau / Sum : 1.0f;
+    }
+
+    //R1.01 First dip under the threshold, followed down to its bottom.
+    int Best = -1;
+    for (int tau = TauMin; tau <= TauMax; tau++)
+    {
+        if (d[tau] < Yin_Threshold)
+        {
+            while ((tau + 1 <= TauMax) && (d[tau + 1] < d[tau])) tau++;
+            Best = tau;
+            break;
+        }
+    }
+
+    //R1.01 Nothing under the threshold, take the lowest point if it is still fairly clear.
+    if (Best < 0)
+    {
+        Best = TauMin;
+        for (int tau = TauMin; tau <= TauMax; tau++)
+            if (d[tau] < d[Best]) Best = tau;
+        if (.35f < d[Best]) return 0.0f;
+    }
+
+    //R1.01 Parabolic interpolation on the raw difference for a fraction of a sample.
+    float a = Raw[Best - 1];
+    float b = Raw[Best];
+    float c = Raw[Best + 1];
+    float Den = a - 2.0f * b + c;
+    float Shift = (0.0f < Den) ? .5f * (a - c) / Den : 0.0f;
+
+    return Fs / (float(Best) + Shift);
+}
+
+void MakoTuner::Push(const float* Data, int Samples)
+{
+    if (!Active.load(std::memory_order_relaxed)) return;
+
+    uint32_t w = Ring_Write.load(std::memory_order_relaxed);
+    uint32_t r = Ring_Read.load(std::memory_order_acquire);
+
+    //R1.01 The worker is behind, just skip this block.
+    if (uint32_t(Ring_Size) - (w - r) < uint32_t(Samples)) return;
+
+    int Pos = int(w & (Ring_Size - 1));
+    int First = std::min(Samples, Ring_Size - Pos);
+    memcpy(Ring + Pos, Data, sizeof(float) * size_t(First));
+    memcpy(Ring, Data + First, sizeof(float) * size_t(Samples - First));
+
+    Ring_Write.store(w + uint32_t(Samples), std::memory_order_release);
+}
+
+void MakoTuner::Start()
+{
+    if (Worker.joinable()) return;
+
+    //R1.01 Forget anything left over from the last time.
+    Ring_Read.store(Ring_Write.load());
+    Freq.store(0.0f);
+    Quit.store(false);
+    Worker = std::thread([this] { Run(); });
+    Active.store(true);
+}
+
+void MakoTuner::Stop()
+{
+    Active.store(false);
+    Quit.store(true);
+    if (Worker.joinable()) Worker.join();
+    Freq.store(0.0f);
+}
+
+void MakoTuner::Note_From_Freq(float Hz, int& Note, int& Cents)
+{
+    float Midi = 69.0f + 12.0f * std::log2(Hz / 440.0f);
+    int n = int(std::lround(Midi));
+
+    Note = ((n % 12) + 12) % 12;
+    Cents = int(std::lround((Midi - float(n)) * 100.0f));
+}
+
+//R1.01 The analysis thread. Low pass (4th order Butterworth), decimate, and run YIN every hop.
+void MakoTuner::Run()
+{
+    double Rate = 0.0;
+    int Dec = 1;
+    int Phase = 0;
+    float Fs = 12000.0f;
+
+    float a0[2] = {}, a1[2] = {}, a2[2] = {}, b1[2] = {}, b2[2] = {};
+    float z1[2] = {}, z2[2] = {};
+
+    float Buf[Yin_Size];
+    int Fill = 0;
+    int NewCount = 0;
+
+    while (!Quit.load())
+    {
+        //R1.01 New sample rate: redesign the decimation filter and start over.
+        if (Rate != Rate_In.load())
+        {
+            Rate = Rate_In.load();
+            Dec = std::max(1, int(Rate / 11025.0));
+            Fs = float(Rate / Dec);
+
+            static const float Q[2] = { .5411961f, 1.3065630f };
+            float w0 = 6.2831853f * (Fs * .2f) / float(Rate);
+            for (int s = 0; s < 2; s++)
+            {
+                float alpha = std::sin(w0) / (2.0f * Q[s]);
+                float cw = std::cos(w0);
+                float n = 1.0f / (1.0f + alpha);
+                a0[s] = (1.0f - cw) * .5f * n;
+                a1[s] = (1.0f - cw) * n;
+                a2[s] = a0[s];
+                b1[s] = -2.0f * cw * n;
+                b2[s] = (1.0f - alpha) * n;
+                z1[s] = z2[s] = 0.0f;
+            }
+            Phase = 0;
+            Fill = 0;
+            NewCount = 0;
+            Freq.store(0.0f);
+        }
+
+        uint32_t r = Ring_Read.load(std::memory_order_relaxed);
+        uint32_t Avail = Ring_Write.load(std::memory_order_acquire) - r;
+        if (Avail == 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            continue;
+        }
+
+        for (uint32_t i = 0; i < Avail; i++)
+        {
+            float y = Ring[(r + i) & (Ring_Size - 1)];
+
+            //R1.01 Transposed direct form II biquads.
+            for (int s = 0; s < 2; s++)
+            {
+                float x = y;
+                y = a0[s] * x + z1[s];
+                z1[s] = a1[s] * x - b1[s] * y + z2[s];
+                z2[s] = a2[s] * x - b2[s] * y;
+            }
+
+            if (++Phase < Dec) continue;
+            Phase = 0;
+
+            //R1.01 Window is full, slide it along by one hop.
+            if (Fill == Yin_Size)
+            {
+                memmove(Buf, Buf + Yin_Hop, sizeof(float) * (Yin_Size - Yin_Hop));
+                Fill -= Yin_Hop;
+            }
+            Buf[Fill++] = y;
+            NewCount++;
+
+            if ((Fill == Yin_Size) && (Yin_Hop <= NewCount))
+            {
+                NewCount = 0;
+                Freq.store(Yin_Detect(Buf, Fs), std::memory_order_relaxed);
+            }
+        }
+        Ring_Read.store(r + Avail, std::memory_order_release);
+    }
+}
@@ -0,0 +1,59 @@
+/*
+  ==============================================================================
+
+    MakoTuner.h
+    R1.01 Built in guitar TUNER.
+
+    The audio thread only copies input samples into a lock free ring.
+    A background thread low passes and decimates them to about 11-12 kHz and
+    runs the YIN pitch detector on that. The thread only exists while the
+    tuner is shown, so a hidden tuner costs nothing.
+
+    Plain C++, no JUCE needed.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+class MakoTuner
+{
+public:
+    MakoTuner() = default;
+    ~MakoTuner() { Stop(); }
+
+    //R1.01 The worker picks a new sample rate up on its own.
+    void SetSampleRate(double Rate) { Rate_In.store(Rate); }
+
+    //R1.01 Audio thread. Copy samples for the tuner, does nothing while it is stopped. Never waits or allocates.
+    void Push(const float* Data, int Samples);
+
+    //R1.01 Message thread. Start and stop the analysis thread.
+    void Start();
+    void Stop();
+    bool IsRunning() const { return Active.load(std::memory_order_relaxed); }
+
+    //R1.01 Latest pitch in Hz, 0 when there is no clear note.
+    float GetFreq() const { return Freq.load(std::memory_order_relaxed); }
+
+    //R1.01 Nearest note (0 = C .. 11 = B) and how far off it is in cents (-50 to +50).
+    static void Note_From_Freq(float Hz, int& Note, int& Cents);
+
+private:
+    static const int Ring_Size = 16384;     //R1.01 Power of 2. Over 80 mS at 192k.
+    float Ring[Ring_Size] = {};
+    std::atomic<uint32_t> Ring_Write{ 0 };  //R1.01 Audio thread only.
+    std::atomic<uint32_t> Ring_Read{ 0 };   //R1.01 Worker thread only.
+
+    std::atomic<bool> Active{ false };
+    std::atomic<bool> Quit{ false };
+    std::atomic<double> Rate_In{ 48000.0 };
+    std::atomic<float> Freq{ 0.0f };
+    std::thread Worker;
+
+    void Run();
+};
@@ -0,0 +1,63 @@
+/*
+  ==============================================================================
+
+    MakoWake.h
+    R1.01 Wake up for our background workers, a counting semaphore.
+
+    Post never blocks or takes a lock, so the audio thread can call it. Every
+    Post is counted, so a wake up sent before the worker starts waiting is
+    never lost and nothing has to poll.
+
+    Plain C++, no JUCE needed. Include it from .cpp files only, it pulls in
+    the platform headers.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <climits>
+
+#if defined(_WIN32)
+ #ifndef NOMINMAX
+  #define NOMINMAX
+ #endif
+ #include <windows.h>
+#elif defined(__APPLE__)
+ #include <dispatch/dispatch.h>
+#else
+ #include <semaphore.h>
+#endif
+
+class MakoWake
+{
+public:
+#if defined(_WIN32)
+    MakoWake() : S(CreateSemaphore(nullptr, 0, LONG_MAX, nullptr)) {}
+    ~MakoWake() { CloseHandle(S); }
+    void Post() { ReleaseSemaphore(S, 1, nullptr); }
+    void Wait() { WaitForSingleObject(S, INFINITE); }
+#elif defined(__APPLE__)
+    MakoWake() : S(dispatch_semaphore_create(0)) {}
+    ~MakoWake() { dispatch_release(S); }
+    void Post() { dispatch_semaphore_signal(S); }
+    void Wait() { dispatch_semaphore_wait(S, DISPATCH_TIME_FOREVER); }
+#else
+    MakoWake() { sem_init(&S, 0, 0); }
+    ~MakoWake() { sem_destroy(&S); }
+    void Post() { sem_post(&S); }
+    void Wait() { while (sem_wait(&S) != 0) {} }
+#endif
+
+    MakoWake(const MakoWake&) = delete;
+    MakoWake& operator=(const MakoWake&) = delete;
+
+private:
+#if defined(_WIN32)
+    HANDLE S;
+#elif defined(__APPLE__)
+    dispatch_semaphore_t S;
+#else
+    sem_t S;
+#endif
+};
@@ -9,35 +9,35 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 
+//R1.01 Knob parameter IDs in knob order, for the left (or linked) and the right channel of DUAL MONO.
+static const char* Mako_Knob_ID[2][9] = {
+    { "gain", "lowcut", "ngate", "drive", "comp1", "comp2", "low", "mid", "high" },
+    { "gain_r", "lowcut_r", "ngate_r", "drive_r", "comp1_r", "comp2_r", "low_r", "mid_r", "high_r" }
+};
+
 //==============================================================================
 MakoBiteAudioProcessorEditor::MakoBiteAudioProcessorEditor (MakoBiteAudioProcessor& p)
     : AudioProcessorEditor (&p), audioProcessor (p)
 {    
     //R1.00 Create SLIDER ATTACHMENTS so our parameter vars get adjusted automatically for Get/Set states.
-    ParAtt[e_Gain] = std::make_unique <juce::AudioProcessorValueTreeState::SliderAttachment>(p.parameters, "gain", sldKnob[e_Gain]);
-    ParAtt[e_LowCut] = std::make_unique <juce::AudioProcessorValueTreeState::SliderAttachment>(p.parameters, "lowcut", sldKnob[e_LowCut]);           
-    ParAtt[e_NGate] = std::make_unique <juce::AudioProcessorValueTreeState::SliderAttachment>(p.parameters, "ngate", sldKnob[e_NGate]);
-    ParAtt[e_Drive] = std::make_unique <juce::AudioProcessorValueTreeState::SliderAttachment>(p.parameters, "drive", sldKnob[e_Drive]);
-    ParAtt[e_Comp1] = std::make_unique <juce::AudioProcessorValueTreeState::SliderAttachment>(p.parameters, "comp1", sldKnob[e_Comp1]);
-    ParAtt[e_Comp2] = std::make_unique <juce::AudioProcessorValueTreeState::SliderAttachment>(p.parameters, "comp2", sldKnob[e_Comp2]);
-    ParAtt[e_Low] = std::make_unique <juce::AudioProcessorValueTreeState::SliderAttachment>(p.parameters, "low", sldKnob[e_Low]);
-    ParAtt[e_Mid] = std::make_unique <juce::AudioProcessorValueTreeState::SliderAttachment>(p.parameters, "mid", sldKnob[e_Mid]);
-    ParAtt[e_High] = std::make_unique <juce::AudioProcessorValueTreeState::SliderAttachment>(p.parameters, "high", sldKnob[e_High]);
+    //R1.01 The knobs start on the left (or linked) channel.
+    Mako_Knobs_Attach(0);
         
-    imgBackground = juce::ImageCache::getFromMemory(BinaryData::precogback01_png, BinaryData::precogback01_pngSize);
+    //R1.01 Let the processor know the meters are being watched.
+    audioProcessor.Engine.Meter_Watched = true;
 
     //****************************************************************************************
     //R1.00 Add GUI CONTROLS
     //****************************************************************************************
-    Mako_Init_Large_Slider(&sldKnob[e_Gain], audioProcessor.Setting[e_Gain],0.0f, 1.0f,.01f,"", 1, 0xFFE0DACE);
-    Mako_Init_Large_Slider(&sldKnob[e_LowCut], audioProcessor.Setting[e_LowCut], 20, 200, 10, "", 1, 0xFF202020);
-    Mako_Init_Large_Slider(&sldKnob[e_NGate], audioProcessor.Setting[e_NGate], 0.0f, 1.0f, .01f, "", 1, 0xFF202020);
-    Mako_Init_Large_Slider(&sldKnob[e_Drive], audioProcessor.Setting[e_Drive], 0.0f, 1.0f, .01f, "", 1, 0xFFE0DACE);
-    Mako_Init_Large_Slider(&sldKnob[e_Comp1], audioProcessor.Setting[e_Comp1], 0.0f, 1.0f, .01f, "", 1, 0xFF202020);
-    Mako_Init_Large_Slider(&sldKnob[e_Comp2], audioProcessor.Setting[e_Comp2], 0.0f, 1.0f, .01f, "", 1, 0xFF202020);
-    Mako_Init_Large_Slider(&sldKnob[e_Low], audioProcessor.Setting[e_Low], -12.0f, 12.0f, .1f, "", 1, 0xFF202020);
-    Mako_Init_Large_Slider(&sldKnob[e_Mid], audioProcessor.Setting[e_Mid], -12.0f, 12.0f, .1f, "", 1, 0xFF202020);
-    Mako_Init_Large_Slider(&sldKnob[e_High], audioProcessor.Setting[e_High], -12.0f, 12.0f, .1f, "", 1, 0xFF202020);
+    Mako_Init_Large_Slider(&sldKnob[e_Gain], audioProcessor.Mako_GetSetting(e_Gain), 0.0f, 1.0f,.01f,"", 1, 0xFFE0DACE);
+    Mako_Init_Large_Slider(&sldKnob[e_LowCut], audioProcessor.Mako_GetSetting(e_LowCut), 20, 200, 10, "", 1, 0xFF202020);
+    Mako_Init_Large_Slider(&sldKnob[e_NGate], audioProcessor.Mako_GetSetting(e_NGate), 0.0f, 1.0f, .01f, "", 1, 0xFF202020);
+    Mako_Init_Large_Slider(&sldKnob[e_Drive], audioProcessor.Mako_GetSetting(e_Drive), 0.0f, 1.0f, .01f, "", 1, 0xFFE0DACE);
+    Mako_Init_Large_Slider(&sldKnob[e_Comp1], audioProcessor.Mako_GetSetting(e_Comp1), 0.0f, 1.0f, .01f, "", 1, 0xFF202020);
+    Mako_Init_Large_Slider(&sldKnob[e_Comp2], audioProcessor.Mako_GetSetting(e_Comp2), 0.0f, 1.0f, .01f, "", 1, 0xFF202020);
+    Mako_Init_Large_Slider(&sldKnob[e_Low], audioProcessor.Mako_GetSetting(e_Low), -12.0f, 12.0f, .1f, "", 1, 0xFF202020);
+    Mako_Init_Large_Slider(&sldKnob[e_Mid], audioProcessor.Mako_GetSetting(e_Mid), -12.0f, 12.0f, .1f, "", 1, 0xFF202020);
+    Mako_Init_Large_Slider(&sldKnob[e_High], audioProcessor.Mako_GetSetting(e_High), -12.0f, 12.0f, .1f, "", 1, 0xFF202020);
     
     //R1.00 Define our control positions to make drawing easier.
     Mako_Knob_DefinePosition(e_LowCut, 10, 60, 50, 50, "LCut");
@@ -54,8 +54,13 @@ MakoBiteAudioProcessorEditor::MakoBiteAudioProcessorEditor (MakoBiteAudioProcess
 
     Knob_Cnt = 9;
 
-    //R2.00 Start our Timer so we can tell the user they are clipping. Could draw VU Meters here, etc.
-    startTimerHz(10);  //R1.00 have our Timer get called 10 times per second.
+    //R1.01 Pick up where the meters are now. After that we look at the engine's flag once per
+    //R1.01 screen refresh, only while we are on screen, and only redraw when it was set.
+    Mako_Meter_Event();
+    Meter_VBlank = juce::VBlankAttachment(this, [this]
+    {
+        if (audioProcessor.Engine.Meter_Dirty.exchange(false, std::memory_order_acquire)) Mako_Meter_Event();
+    });
 
     //R1.00 Update the Look and Feel (Global colors) so drop down menu is the correct color. 
     getLookAndFeel().setColour(juce::DocumentWindow::backgroundColourId, juce::Colour(32, 32, 32));
@@ -73,11 +78,21 @@ MakoBiteAudioProcessorEditor::MakoBiteAudioProcessorEditor (MakoBiteAudioProcess
     // editor's size to whatever you need it to be.
     
     //R1.00 Set the window size.
-    setSize(490, 130);
+    //R1.01 The window can be resized, keeping our shape. Start at the last size the user picked.
+    setOpaque(true);
+    setResizable(true, true);
+    setResizeLimits(UI_Width / 2, UI_Height / 2, UI_Width * 4, UI_Height * 4);
+    getConstrainer()->setFixedAspectRatio(double(UI_Width) / double(UI_Height));
+    float Scale = juce::jlimit(.5f, 4.0f, audioProcessor.UI_Scale);
+    setSize(juce::roundToInt(UI_Width * Scale), juce::roundToInt(UI_Height * Scale));
 }
 
 MakoBiteAudioProcessorEditor::~MakoBiteAudioProcessorEditor()
 {
+    audioProcessor.Engine.Meter_Watched = false;
+
+    //R1.01 Nobody can see the tuner now, stop its thread.
+    audioProcessor.Tuner.Stop();
 }
 
 //==============================================================================
@@ -86,19 +101,133 @@ void MakoBiteAudioProcessorEditor::paint (juce::Graphics& g)
     // (Our component is opaque, so we must completely fill the background with a solid colour)
     //g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
     
-    bool UseImage = true;
     juce::ColourGradient ColGrad;
 
+    //R1.01 Draw the static background layer. It is prerendered at the screens real pixel size,
+    //R1.01 so this is a single 1:1 image copy just like the old fixed size bitmap.
+    float PixelScale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    g.drawImage(Mako_Layer_Get(PixelScale), getLocalBounds().toFloat());
+
+    //R1.01 Everything else is drawn in our original 490 x 130 coordinates and scaled to fit.
+    g.addTransform(juce::AffineTransform::scale(UI_Scale));
+    
+    //R1.00 Draw the Compression indicator LED and Limit Line.
+    //R1.01 In DUAL MONO the line is the threshold of the side the knobs edit.
+    if (audioProcessor.Mako_GetSetting(e_Comp1, Edit_Side) < 1.0f)
+    {
+        //R1.00 Limit Line.
+        g.setColour(juce::Colour(0xFF0080B0));
+        int Coff = audioProcessor.Mako_GetSetting(e_Comp1, Edit_Side) * 150;
+        g.drawLine(13 + Coff, 12, 13 + Coff, 30, 2.0f);
+        g.drawLine(328 + Coff, 12, 328 + Coff, 30, 2.0f);
+
+        //R1.00 Indicator LED.
+        //R1.01 Lit by the gain reduction the compressor is really doing.
+        if (Compressing)
+        {
+            g.setColour(juce::Colour(0xFF00E0FF));
+            g.fillEllipse(150, 50, 6, 6);
+        }
+    }
+
+    //**********************************************
+    //R1.00 LEFT VU Meter bar
+    //**********************************************
+    g.setColour(juce::Colour(0xFF00C0B0));
+    g.fillRect(13, 15, int(150 * VULast[0] * .01f), 2);
+    
+    ColGrad = juce::ColourGradient(juce::Colour(0xFF00FFC0), 10.0f, 0.0f, juce::Colour(0xFFFF0000), 195.0f, 0.0f, false);
+    g.setGradientFill(ColGrad);
+    g.fillRect(13, 21, int(150 * VULast[2] * .01f), 6);
+    
+    //R1.00 If clipping draw the OverLoad LED on. Clip count will be a number above 0.  
+    if (ClipCount[2])
+    {
+        g.setColour(juce::Colours::red);
+        g.fillEllipse(172, 22, 6, 6);        
+    }
+    
+    //**********************************************
+    //R1.00 RIGHT VU Meter bar.
+    //**********************************************
+    g.setColour(juce::Colour(0xFF00C0B0));
+    g.fillRect(328, 15, int(150 * VULast[1] * .01f), 2);
+
+    ColGrad = juce::ColourGradient(juce::Colour(0xFF00FFC0), 325.0f, 0.0f, juce::Colour(0xFFFF0000), 520.0f, 0.0f, false);
+    g.setGradientFill(ColGrad);
+    g.fillRect(328, 21, int(150 * VULast[3] * .01f), 6);
+        
+    //R1.00 If clipping draw the OverLoad LED on. Clip count will be a number above 0.  
+    if (ClipCount[3])
+    {
+        g.setColour(juce::Colours::red);
+        g.fillEllipse(312, 22, 6, 6);
+    }
+
+    //R1.01 Adaptive quality has stepped down, show the tier next to the version number.
+    if (0 < Tier_Last)
+    {
+        g.setColour(juce::Colour(0xFFFFA000));
+        g.setFont(10.0f);
+        g.drawText("Q" + juce::String(Tier_Last), 74, 114, 20, 12, juce::Justification::centredLeft, false);
+    }
+
+    //R1.01 DUAL MONO. The knobs are showing the right channel.
+    if (Edit_Side == 1)
+    {
+        g.setColour(juce::Colour(0xFFFF4040));
+        g.setFont(10.0f);
+        g.drawText("EDIT R", 94, 114, 40, 12, juce::Justification::centredLeft, false);
+    }
+
+    //**********************************************
+    //R1.01 TUNER. Note name and a cents pointer, +-50 cents across the bar.
+    //**********************************************
+    if (Tuner_Show)
+    {
+        static const char* NoteName[12] = { "C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B" };
+        float Hz = audioProcessor.Tuner.GetFreq();
+
+        g.setColour(juce::Colour(0xFF000000));
+        g.fillRect(186, 8, 118, 26);
+        g.setColour(juce::Colour(0xFF606060));
+        g.fillRect(260, 12, 1, 18);
+
+        g.setFont(14.0f);
+        if (Hz <= 0.0f)
+        {
+            g.setColour(juce::Colour(0xFF606060));
+            g.drawText("--", 188, 9, 30, 24, juce::Justification::centred, false);
+        }
+        else
+        {
+            int Note, Cents;
+            MakoTuner::Note_From_Freq(Hz, Note, Cents);
+            g.setColour((abs(Cents) <= 3) ? juce::Colour(0xFF00FF60) : juce::Colour(0xFFFFFFFF));
+            g.drawText(NoteName[Note], 188, 9, 30, 24, juce::Justification::centred, false);
+
+            g.setColour((abs(Cents) <= 3) ? juce::Colour(0xFF00FF60) : juce::Colour(0xFFE04000));
+            g.fillRect(259 + int(Cents * .8f), 12, 3, 18);
+        }
+    }
+}
+
+//R1.01 Draw everything that never changes. Only called when a new layer image is rendered.
+void MakoBiteAudioProcessorEditor::Mako_Draw_Static(juce::Graphics& g)
+{
+    bool UseImage = true;
+
     if (UseImage)
     {
-        g.drawImageAt(imgBackground, 0, 0);        
+        g.setImageResamplingQuality(juce::Graphics::highResamplingQuality);
+        g.drawImageAt(SharedUI->Background, 0, 0);        
     }
     else
     {
         //R1.00 Draw our GUI.
         //R1.00 Background.
         g.setColour(juce::Colour(0xFFFFFFFF));
-        g.fillRect(0, 0, 490, 130);
+        g.fillRect(0, 0, UI_Width, UI_Height);
         
         //R1.00 Draw LOGO text.
         g.setColour(juce::Colour(0xFF404040));
@@ -136,58 +265,47 @@ void MakoBiteAudioProcessorEditor::paint (juce::Graphics& g)
         g.drawFittedText("Right Channel", 325, 32, 155, 15, juce::Justification::centredRight, 1);
         g.drawFittedText("ov", 305, 10, 20, 10, juce::Justification::centred, 1);
     }    
-    
-    //R1.00 Draw the Compression indicator LED and Limit Line.
-    if (audioProcessor.Setting[e_Comp1] < 1.0f)
-    {
-        //R1.00 Limit Line.
-        g.setColour(juce::Colour(0xFF0080B0));
-        int Coff = audioProcessor.Setting[e_Comp1] * 150;
-        g.drawLine(13 + Coff, 12, 13 + Coff, 30, 2.0f);
-        g.drawLine(328 + Coff, 12, 328 + Coff, 30, 2.0f);
+}
 
-        //R1.00 Indicator LED.
-        if ((audioProcessor.Setting[e_Comp1] < audioProcessor.VUValue[2]) || (audioProcessor.Setting[e_Comp1] < audioProcessor.VUValue[3]))
+//R1.01 Get the static background layer for our current size and screen pixel scale.
+//R1.01 Layers are shared by all editors, so moving between a normal and a HiDPI monitor
+//R1.01 or opening another instance at the same size does not rerender.
+//R1.01 While the user is dragging the window size we stretch the old layer instead of
+//R1.01 rendering a new one every frame. The timer renders the new one once dragging stops.
+const juce::Image& MakoBiteAudioProcessorEditor::Mako_Layer_Get(float PixelScale)
+{
+    auto& UI = *SharedUI;
+    int W = juce::roundToInt(getWidth() * PixelScale);
+    int H = juce::roundToInt(getHeight() * PixelScale);
+    int Oldest = 0;
+
+    UI.LayerClock++;
+    for (int t = 0; t < 4; t++)
+    {
+        if (UI.Layer[t].Img.isValid() && (UI.Layer[t].Width == W) && (UI.Layer[t].Height == H))
         {
-            g.setColour(juce::Colour(0xFF00E0FF));
-            g.fillEllipse(150, 50, 6, 6);
+            UI.Layer[t].LastUsed = UI.LayerClock;
+            Layer_Last = t;
+            return UI.Layer[t].Img;
         }
+        if (UI.Layer[t].LastUsed < UI.Layer[Oldest].LastUsed) Oldest = t;
     }
 
-    //**********************************************
-    //R1.00 LEFT VU Meter bar
-    //**********************************************
-    g.setColour(juce::Colour(0xFF00C0B0));
-    g.fillRect(13, 15, int(150 * VULast[0] * .01f), 2);
-    
-    ColGrad = juce::ColourGradient(juce::Colour(0xFF00FFC0), 10.0f, 0.0f, juce::Colour(0xFFFF0000), 195.0f, 0.0f, false);
-    g.setGradientFill(ColGrad);
-    g.fillRect(13, 21, int(150 * VULast[2] * .01f), 6);
-    
-    //R1.00 If clipping draw the OverLoad LED on. Clip count will be a number above 0.  
-    if (ClipCount[2])
-    {
-        g.setColour(juce::Colours::red);
-        g.fillEllipse(172, 22, 6, 6);        
-    }
-    
-    //**********************************************
-    //R1.00 RIGHT VU Meter bar.
-    //**********************************************
-    g.setColour(juce::Colour(0xFF00C0B0));
-    g.fillRect(328, 15, int(150 * VULast[1] * .01f), 2);
+    if ((0 < Resize_Ticks) && UI.Layer[Layer_Last].Img.isValid()) return UI.Layer[Layer_Last].Img;
 
-    ColGrad = juce::ColourGradient(juce::Colour(0xFF00FFC0), 325.0f, 0.0f, juce::Colour(0xFFFF0000), 520.0f, 0.0f, false);
-    g.setGradientFill(ColGrad);
-    g.fillRect(328, 21, int(150 * VULast[3] * .01f), 6);
-        
-    //R1.00 If clipping draw the OverLoad LED on. Clip count will be a number above 0.  
-    if (ClipCount[3])
-    {
-        g.setColour(juce::Colours::red);
-        g.fillEllipse(312, 22, 6, 6);
-    }
+    //R1.01 Replace the layer that has not been used for the longest time.
+    auto& L = UI.Layer[Oldest];
+    L.Img = juce::Image(juce::Image::RGB, juce::jmax(1, W), juce::jmax(1, H), false);
+    L.Width = W;
+    L.Height = H;
+    L.LastUsed = UI.LayerClock;
 
+    juce::Graphics lg(L.Img);
+    lg.addTransform(juce::AffineTransform::scale(W / float(UI_Width), H / float(UI_Height)));
+    Mako_Draw_Static(lg);
+
+    Layer_Last = Oldest;
+    return L.Img;
 }
 
 void MakoBiteAudioProcessorEditor::resized()
@@ -195,8 +313,21 @@ void MakoBiteAudioProcessorEditor::resized()
     // This is generally where you'll want to lay out the positions of any
     // subcomponents in your editor..
 
+    //R1.01 Our scale compared to the original 490 x 130 window. Remember it for next time.
+    UI_Scale = getWidth() / float(UI_Width);
+    audioProcessor.UI_Scale = UI_Scale;
+
+    //R1.01 Start the resize countdown. The background layer is rerendered once it stops changing.
+    Resize_Ticks = 3;
+    Mako_Timer_Wake();
+
     //R1.00 Define positions for all of our KNOBS.
-    for (int t = 0; t < Knob_Cnt; t++) sldKnob[t].setBounds(Knob_Pos[t].x, Knob_Pos[t].y, Knob_Pos[t].sizex, Knob_Pos[t].sizey);    
+    //R1.01 Positions stay in our original coords, the transform scales them to the window size.
+    for (int t = 0; t < Knob_Cnt; t++)
+    {
+        sldKnob[t].setBounds(Knob_Pos[t].x, Knob_Pos[t].y, Knob_Pos[t].sizex, Knob_Pos[t].sizey);
+        sldKnob[t].setTransform(juce::AffineTransform::scale(UI_Scale));
+    }
 }
 
 
@@ -212,7 +343,7 @@ void MakoBiteAudioProcessorEditor::Mako_Init_Large_Slider(juce::Slider* slider,
     addAndMakeVisible(slider);
 
     //R1.00 Override the default Juce drawing routines and use ours.
-    slider->setLookAndFeel(&myLookAndFeel);
+    slider->setLookAndFeel(&SharedUI->LookAndFeel);
 
     //R1.00 Setup the type and colors for the sliders.
     slider->setSliderStyle(juce::Slider::SliderStyle::Rotary);
@@ -237,6 +368,214 @@ void MakoBiteAudioProcessorEditor::Mako_Knob_DefinePosition(int idx,float x, flo
     Knob_Name[idx] = name;
 }
 
+//R1.01 Show our options menu on a right click (or ctrl click) of the background.
+void MakoBiteAudioProcessorEditor::mouseDown(const juce::MouseEvent& e)
+{
+    if (e.mods.isPopupMenu()) Mako_Options_Menu();
+}
+
+//R1.01 Build and show the options menu. Item IDs are 100 * menu group + choice index.
+void MakoBiteAudioProcessorEditor::Mako_Options_Menu()
+{
+    juce::PopupMenu Menu;
+    juce::PopupMenu MenuChain;
+
+    //R1.01 Signal chain order.
+    auto* pChain = dynamic_cast<juce::AudioParameterChoice*>(audioProcessor.parameters.getParameter("chain"));
+    if (pChain != nullptr)
+    {
+        for (int t = 0; t < pChain->choices.size(); t++) MenuChain.addItem(100 + t, pChain->choices[t], true, pChain->getIndex() == t);
+        Menu.addSubMenu("Signal Chain", MenuChain);
+    }
+
+    //R1.01 Where the shared envelope detector sits.
+    auto* pDetPos = dynamic_cast<juce::AudioParameterChoice*>(audioProcessor.parameters.getParameter("detpos"));
+    if (pDetPos != nullptr)
+    {
+        juce::PopupMenu MenuDet;
+        for (int t = 0; t < pDetPos->choices.size(); t++) MenuDet.addItem(300 + t, pDetPos->choices[t], true, pDetPos->getIndex() == t);
+        Menu.addSubMenu("Detector Position", MenuDet);
+    }
+
+    //R1.01 Mono fast path.
+    auto* pMono = dynamic_cast<juce::AudioParameterChoice*>(audioProcessor.parameters.getParameter("mono"));
+    if (pMono != nullptr)
+    {
+        juce::PopupMenu MenuMono;
+        for (int t = 0; t < pMono->choices.size(); t++) MenuMono.addItem(500 + t, pMono->choices[t], true, pMono->getIndex() == t);
+        Menu.addSubMenu("Mono Mode", MenuMono);
+    }
+
+    //R1.01 Multiband compressor.
+    auto* pBands = dynamic_cast<juce::AudioParameterChoice*>(audioProcessor.parameters.getParameter("compbands"));
+    if (pBands != nullptr)
+    {
+        juce::PopupMenu MenuBands;
+        for (int t = 0; t < pBands->choices.size(); t++) MenuBands.addItem(400 + t, pBands->choices[t], true, pBands->getIndex() == t);
+        Menu.addSubMenu("Compressor Bands", MenuBands);
+    }
+
+    //R1.01 Output limiter.
+    auto* pLimit = dynamic_cast<juce::AudioParameterChoice*>(audioProcessor.parameters.getParameter("limiter"));
+    if (pLimit != nullptr)
+    {
+        juce::PopupMenu MenuLimit;
+        for (int t = 0; t < pLimit->choices.size(); t++) MenuLimit.addItem(900 + t, pLimit->choices[t], true, pLimit->getIndex() == t);
+        Menu.addSubMenu("Output Limiter", MenuLimit);
+    }
+
+    //R1.01 Cab IR loader.
+    juce::PopupMenu MenuCab;
+    MenuCab.addItem(600, "Load Cab IR...");
+    MenuCab.addItem(601, "Cab IR Off", audioProcessor.IR_Path.isNotEmpty());
+    if (audioProcessor.IR_Path.isNotEmpty())
+    {
+        MenuCab.addSeparator();
+        MenuCab.addItem(602, juce::File(audioProcessor.IR_Path).getFileName(), false, true);
+    }
+    Menu.addSubMenu("Cab IR", MenuCab);
+
+    //R1.01 Adaptive quality, and the tier it is running at now.
+    auto* pQuality = dynamic_cast<juce::AudioParameterChoice*>(audioProcessor.parameters.getParameter("quality"));
+    if (pQuality != nullptr)
+    {
+        static const char* TierName[MakoEngine::e_Tier_Count] = { "Full", "Fast Drive", "Lean EQ" };
+        juce::PopupMenu MenuQuality;
+        for (int t = 0; t < pQuality->choices.size(); t++) MenuQuality.addItem(800 + t, pQuality->choices[t], true, pQuality->getIndex() == t);
+        MenuQuality.addSeparator();
+        MenuQuality.addItem(899, juce::String("Now: ") + TierName[audioProcessor.Engine.Quality_Tier.load()], false, false);
+        Menu.addSubMenu("Quality", MenuQuality);
+    }
+
+    //R1.01 DSP kernel instruction set. A forced path starts the next time the host prepares us.
+    juce::PopupMenu MenuKernels;
+    int Force = audioProcessor.Engine.Kernel_Force.load();
+    for (int t = 0; t < MakoKernels::e_Path_Count; t++)
+        MenuKernels.addItem(1000 + t, MakoKernels::Name(t), t <= MakoKernels::Best(), Force == t);
+    MenuKernels.addSeparator();
+    MenuKernels.addItem(1099, juce::String("Now: ") + audioProcessor.Engine.Mako_Kernels_Name(), false, false);
+    Menu.addSubMenu("DSP Kernels", MenuKernels);
+
+    //R1.01 Dual mono, and which channel the knobs edit.
+    auto* pDual = dynamic_cast<juce::AudioParameterBool*>(audioProcessor.parameters.getParameter("dual"));
+    if (pDual != nullptr)
+    {
+        juce::PopupMenu MenuDual;
+        MenuDual.addItem(1100, "Linked (L = R)", true, !pDual->get());
+        MenuDual.addItem(1101, "Dual Mono", true, pDual->get());
+        MenuDual.addSeparator();
+        MenuDual.addItem(1110, "Knobs Edit Left", pDual->get(), Edit_Side == 0);
+        MenuDual.addItem(1111, "Knobs Edit Right", pDual->get(), Edit_Side == 1);
+        Menu.addSubMenu("Dual Mono", MenuDual);
+    }
+
+    //R1.01 Drive anti-aliasing.
+    auto* pDriveAA = dynamic_cast<juce::AudioParameterChoice*>(audioProcessor.parameters.getParameter("driveaa"));
+    if (pDriveAA != nullptr)
+    {
+        juce::PopupMenu MenuAA;
+        for (int t = 0; t < pDriveAA->choices.size(); t++) MenuAA.addItem(1300 + t, pDriveAA->choices[t], true, pDriveAA->getIndex() == t);
+        Menu.addSubMenu("Drive Anti-Alias", MenuAA);
+    }
+
+    //R1.01 Dynamic EQ. The band thresholds, ratios and times are host parameters.
+    auto* pDynEQ = dynamic_cast<juce::AudioParameterBool*>(audioProcessor.parameters.getParameter("dyneq"));
+    if (pDynEQ != nullptr) Menu.addItem(1200, "Dynamic EQ", true, pDynEQ->get());
+
+    //R1.01 Tuner.
+    Menu.addItem(700, "Tuner", true, Tuner_Show);
+
+    //R1.01 High density mode for big sessions.
+    Menu.addItem(200, "High Density Mode", true, audioProcessor.Mako_Density_Get());
+
+    //R1.01 The editor may be closed before the menu returns, so use a safe pointer.
+    juce::Component::SafePointer<MakoBiteAudioProcessorEditor> Editor(this);
+    Menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(this).withMousePosition(), [Editor](int Result)
+        {
+            if ((Editor == nullptr) || (Result <= 0)) return;
+            if (Result / 100 == 1) Editor->Mako_Set_Choice("chain", Result % 100);
+            if (Result / 100 == 3) Editor->Mako_Set_Choice("detpos", Result % 100);
+            if (Result / 100 == 4) Editor->Mako_Set_Choice("compbands", Result % 100);
+            if (Result / 100 == 5) Editor->Mako_Set_Choice("mono", Result % 100);
+            if (Result / 100 == 8) Editor->Mako_Set_Choice("quality", Result % 100);
+            if (Result / 100 == 9) Editor->Mako_Set_Choice("limiter", Result % 100);
+            if (Result / 100 == 10) Editor->audioProcessor.Engine.Kernel_Force.store(Result % 100);
+            if ((Result == 1100) || (Result == 1101)) Editor->Mako_Dual_Set(Result == 1101);
+            if ((Result == 1110) || (Result == 1111)) Editor->Mako_Knobs_Attach(Result - 1110);
+            if (Result / 100 == 13) Editor->Mako_Set_Choice("driveaa", Result % 100);
+            if (Result == 1200) Editor->Mako_Set_Choice("dyneq", (.5f <= Editor->audioProcessor.Engine.GetParam(MakoEngine::e_Parm_DynEQ)) ? 0 : 1);
+            if (Result == 700) Editor->Mako_Tuner_Show(!Editor->Tuner_Show);
+            if (Result == 600) Editor->Mako_IR_Browse();
+            if (Result == 601) Editor->audioProcessor.Mako_IR_Clear();
+            if (Result == 200) Editor->audioProcessor.Mako_Density_Set(!Editor->audioProcessor.Mako_Density_Get());
+        });
+}
+
+//R1.01 Show or hide the tuner. The analysis thread only runs while it is showing.
+void MakoBiteAudioProcessorEditor::Mako_Tuner_Show(bool Show)
+{
+    Tuner_Show = Show;
+    Tuner_Last = -1;
+    if (Show)
+        audioProcessor.Tuner.Start();
+    else
+        audioProcessor.Tuner.Stop();
+    Mako_Timer_Wake();
+    repaint();
+}
+
+//R1.01 Pick a cab IR file and load it.
+void MakoBiteAudioProcessorEditor::Mako_IR_Browse()
+{
+    IR_Chooser = std::make_unique<juce::FileChooser>("Load Cab IR", juce::File(audioProcessor.IR_Path), "*.wav;*.aif;*.aiff;*.flac");
+
+    juce::Component::SafePointer<MakoBiteAudioProcessorEditor> Editor(this);
+    IR_Chooser->launchAsync(juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles, [Editor](const juce::FileChooser& Chooser)
+        {
+            if (Editor == nullptr) return;
+            juce::File Result = Chooser.getResult();
+            if (Result.existsAsFile()) Editor->audioProcessor.Mako_IR_Load(Result);
+        });
+}
+
+//R1.01 Point the knobs at the left (0) or right (1) channel parameters.
+void MakoBiteAudioProcessorEditor::Mako_Knobs_Attach(int Side)
+{
+    Edit_Side = Side;
+    for (int t = 0; t < e_Knob_Count; t++)
+    {
+        ParAtt[t].reset();
+        ParAtt[t] = std::make_unique <juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.parameters, Mako_Knob_ID[Side][t], sldKnob[t]);
+    }
+    repaint();
+}
+
+//R1.01 Turn dual mono on or off. Going dual the right channel starts from the left channel's knobs,
+//R1.01 so nothing changes until a knob is moved.
+void MakoBiteAudioProcessorEditor::Mako_Dual_Set(bool On)
+{
+    auto* pDual = audioProcessor.parameters.getParameter("dual");
+    if (pDual == nullptr) return;
+
+    if (On && (pDual->getValue() < .5f))
+    {
+        for (int t = 0; t < e_Knob_Count; t++)
+        {
+            auto* Right = audioProcessor.parameters.getParameter(Mako_Knob_ID[1][t]);
+            if (Right != nullptr) Right->setValueNotifyingHost(Right->convertTo0to1(audioProcessor.Mako_GetSetting(t)));
+        }
+    }
+    pDual->setValueNotifyingHost(On ? 1.0f : 0.0f);
+    if (!On) Mako_Knobs_Attach(0);
+}
+
+//R1.01 Set a choice parameter and let the host know about it.
+void MakoBiteAudioProcessorEditor::Mako_Set_Choice(juce::String ParmID, int Index)
+{
+    auto* Parm = audioProcessor.parameters.getParameter(ParmID);
+    if (Parm != nullptr) Parm->setValueNotifyingHost(Parm->convertTo0to1(float(Index)));
+}
+
 //R1.00 This gets called when a knob or slider ar adjusted.
 void MakoBiteAudioProcessorEditor::sliderValueChanged(juce::Slider* slider)
 {  
@@ -247,13 +586,8 @@ void MakoBiteAudioProcessorEditor::sliderValueChanged(juce::Slider* slider)
     {
         if (slider == &sldKnob[t])
         {            
-            //R1.00 Update the actual processor variable being edited.
-            audioProcessor.Setting[t] = float(sldKnob[t].getValue());
-
-            //R1.00 We need to update settings in processor.
-            //R1.00 Increment changed var to be sure every change gets made. Changed var is decremented in processor.
-            audioProcessor.SettingsChanged += 1;
-
+            //R1.01 The slider attachment sets the parameter, and the processor's parameter
+            //R1.01 listener flags it for new coefficients. Nothing to pass on from here.
             if (t == e_Comp1) repaint();
 
             //R1.00 We have captured the correct slider change, exit this function.
@@ -264,47 +598,112 @@ void MakoBiteAudioProcessorEditor::sliderValueChanged(juce::Slider* slider)
     return;
 }
 
-//R1.00 This timer gets called to update our UI VU meters.
-//R1.00 Redrawing the UI is very CPU heavy so we are trying to only REDRAW when something has changed.
+//R1.01 METER EVENT. Runs on a screen refresh when the engine flagged a change, at most 60 times per second
+//R1.01 and only when something we draw has changed. Redrawing the UI is very CPU heavy, so we still only REDRAW when a value we show changed.
 //R1.00 We convert our VU value to 0-100 integer to track changes easier and reduce draws.
-void MakoBiteAudioProcessorEditor::timerCallback()
+void MakoBiteAudioProcessorEditor::Mako_Meter_Event()
 {
-    int tUV[4];
     bool Redraw = false;
 
     //R1.00 loop thru our Input/Output VU values.
     for (int t = 0; t < 4; t++)
     {
-        tUV[t] = int(audioProcessor.VUValue[t] * 100);
-        if (tUV[t] != VULast[t])
+        //R1.01 True peaks can go over 1.0, the bars stop at full scale.
+        int tUV = juce::jmin(100, int(audioProcessor.Engine.Meter_Level[t].load(std::memory_order_relaxed) * 100));
+        if (tUV != VULast[t])
         {
-            VULast[t] = tUV[t];
+            VULast[t] = tUV;
             Redraw = true;
         }
+    }
 
-        //R1.00 We are clipping. Set clipcount so the OV LED stays lit for about a second.
-        if (.99f < audioProcessor.VUValue[t])
+    //R1.00 We are clipping. Set clipcount so the OV LED stays lit for about a second.
+    int Clip = audioProcessor.Engine.Meter_Clip.load(std::memory_order_relaxed);
+    for (int t = 2; t < 4; t++)
+    {
+        if (Clip & (1 << (t - 2)))
         {
+            if (ClipCount[t] == 0) Redraw = true;
             ClipCount[t] = 11;
-            Redraw = true;
         }
+    }
 
-        //R1.00 Reset out peak value or gradually decrease the peak value.
-        audioProcessor.VUValue[t] = 0.0f; // *= 0.5f;
+    //R1.01 Compressor LED, on past .5 dB of gain reduction.
+    bool Comp = (audioProcessor.Engine.Meter_GR.load(std::memory_order_relaxed) < -.5f);
+    if (Comp != Compressing)
+    {
+        Compressing = Comp;
+        Redraw = true;
+    }
 
-        //R1.00 Countdown our LEFT CLIP/OV indicator. 
-        //R1.00 If the indicator needs changed, set REDRAW to true.
-        ClipCount[t]--;
-        if (ClipCount[t] < 0) ClipCount[t] = 0;
-        if (ClipCount[t])
-            Clipping[t] = true;
-        else
-            Clipping[t] = false;
-        if (Clipping[t] != Clipping_Last[t]) Redraw = true;
-        Clipping_Last[t] = Clipping[t];
+    //R1.01 Adaptive quality tier changed.
+    if (audioProcessor.Engine.Quality_Tier.load() != Tier_Last)
+    {
+        Tier_Last = audioProcessor.Engine.Quality_Tier.load();
+        Redraw = true;
     }
 
+    if (Redraw) repaint();
+    Mako_Timer_Wake();
+}
+
+//R1.01 The timer is only needed while something animates on its own.
+bool MakoBiteAudioProcessorEditor::Mako_Timer_Needed() const
+{
+    return Tuner_Show || (0 < Resize_Ticks) || (0 < ClipCount[2]) || (0 < ClipCount[3]);
+}
+
+void MakoBiteAudioProcessorEditor::Mako_Timer_Wake()
+{
+    //R1.00 have our Timer get called 10 times per second.
+    if (Mako_Timer_Needed() && !isTimerRunning()) startTimerHz(10);
+}
+
+//R1.00 This timer counts down the OV LEDs.
+//R1.01 It also polls the tuner and finishes a resize, then stops once there is nothing left to do.
+void MakoBiteAudioProcessorEditor::timerCallback()
+{
+    bool Redraw = false;
+
+    //R1.00 Countdown our CLIP/OV indicators. 
+    //R1.00 If the indicator needs changed, set REDRAW to true.
+    for (int t = 2; t < 4; t++)
+    {
+        if (0 < ClipCount[t])
+        {
+            ClipCount[t]--;
+            if (ClipCount[t] == 0) Redraw = true;
+        }
+    }
+
+    //R1.01 Tuner, only redraw when the note or cents change.
+    if (Tuner_Show)
+    {
+        int Key = 0;
+        float Hz = audioProcessor.Tuner.GetFreq();
+        if (0.0f < Hz)
+        {
+            int Note, Cents;
+            MakoTuner::Note_From_Freq(Hz, Note, Cents);
+            Key = 1 + Note * 101 + (Cents + 50);
+        }
+        if (Key != Tuner_Last)
+        {
+            Tuner_Last = Key;
+            Redraw = true;
+        }
+    }
+
+    //R1.01 Window size has stopped changing, draw once more to render a sharp background layer.
+    if (0 < Resize_Ticks)
+    {
+        Resize_Ticks--;
+        if (Resize_Ticks == 0) Redraw = true;
+    }
 
     //R1.00 If we had a value change, we need to redraw the screen.
     if (Redraw) repaint();    
+
+    //R1.01 Nothing left to animate, sleep until the engine flags new meters.
+    if (!Mako_Timer_Needed()) stopTimer();
 }
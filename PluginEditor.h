@@ -217,6 +217,27 @@ public:
 };
 
 
+//*******************************************************************************************************************
+//R1.01 UI objects that never change. One copy is shared by every editor in the session.
+//R1.01 Only used on the message thread so no locking is needed.
+//*******************************************************************************************************************
+struct MakoSharedUI
+{
+    //R1.01 Prerendered static background layer at a real screen pixel size.
+    struct tp_layer {
+        juce::Image Img;
+        int Width;
+        int Height;
+        int LastUsed;
+    };
+
+    MakoLookAndFeel LookAndFeel;
+    juce::Image Background = juce::ImageCache::getFromMemory(BinaryData::precogback01_png, BinaryData::precogback01_pngSize);
+    tp_layer Layer[4] = {};
+    int LayerClock = 0;
+};
+
+
 //*******************************************************************************************************************
 //R1.00 Add SLIDER listener. BUTTON or TIMER listeners also go here if needed. Must add ValueChanged overrides!
 //*******************************************************************************************************************
@@ -234,42 +255,81 @@ public:
     void paint (juce::Graphics&) override;
     void resized() override;
 
+    //R1.01 Right click on the background shows our options menu.
+    void mouseDown(const juce::MouseEvent& e) override;
+
 private:
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
     MakoBiteAudioProcessor& audioProcessor;
 
-    MakoLookAndFeel myLookAndFeel;
+    //R1.01 Look and feel, background image and prerendered layers shared by all editors.
+    juce::SharedResourcePointer<MakoSharedUI> SharedUI;
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MakoBiteAudioProcessorEditor)
 
-    juce::Image imgBackground;
+    //R1.01 Our original design size. All drawing coords are based on this and scaled.
+    const int UI_Width = 490;
+    const int UI_Height = 130;
+    float UI_Scale = 1.0f;
+
+    //R1.01 Static background layers live in SharedUI.
+    int Layer_Last = 0;
+    int Resize_Ticks = 0;
+    const juce::Image& Mako_Layer_Get(float PixelScale);
+    void Mako_Draw_Static(juce::Graphics& g);
 
     void Mako_Init_Large_Slider(juce::Slider* slider, float Val, float Vmin, float Vmax, float Vinterval, juce::String Suffix, int TickStyle, int ThumbColor);
     
+    //R1.00 These are the indexes into our Settings var.
+    enum { e_Gain, e_LowCut, e_NGate, e_Drive, e_Comp1, e_Comp2, e_Low, e_Mid, e_High, e_Knob_Count };
+
     //R1.00 Need vars to track if we clipped and what has been drawn already.
     int VULast[4] = {};
     int ClipCount[4] = {};
-    bool Clipping[4] = {};
-    bool Clipping_Last[4] = {};
     bool Compressing = false;
+
+    //R1.01 METER EVENTS. The engine flags when the meters changed, the VBlank attachment checks the flag
+    //R1.01 each screen refresh. The timer only runs while something is animating (OV LED hold, tuner,
+    //R1.01 resize) and stops itself after.
+    juce::VBlankAttachment Meter_VBlank;
+    void Mako_Meter_Event();
+    bool Mako_Timer_Needed() const;
+    void Mako_Timer_Wake();
     
     //R1.00 Define our UI Juce Slider controls.
     int Knob_Cnt = 0;
-    juce::Slider sldKnob[20];
-    juce::Slider jsP1_Mono;
+    juce::Slider sldKnob[e_Knob_Count];
 
     //R1.00 Define the coords and text for our knobs. Not JUCE related. 
-    t_KnobCoors Knob_Pos[20] = {};
-    juce::String Knob_Name[20] = {};
+    t_KnobCoors Knob_Pos[e_Knob_Count] = {};
+    juce::String Knob_Name[e_Knob_Count] = {};
     void Mako_Knob_DefinePosition(int t, float x, float y, float sizex, float sizey, juce::String name);
 
-    //R1.00 These are the indexes into our Settings var.
-    enum { e_Gain, e_LowCut, e_NGate, e_Drive, e_Comp1, e_Comp2, e_Low, e_Mid, e_High };
+    //R1.01 Options menu for settings that do not have a knob.
+    void Mako_Options_Menu();
+    void Mako_Set_Choice(juce::String ParmID, int Index);
+
+    //R1.01 DUAL MONO. Which channel the knobs edit, 0 left (or both when linked), 1 right.
+    int Edit_Side = 0;
+    void Mako_Knobs_Attach(int Side);
+    void Mako_Dual_Set(bool On);
+
+    //R1.01 Cab IR file browser. Kept alive while it is open.
+    std::unique_ptr<juce::FileChooser> IR_Chooser;
+    void Mako_IR_Browse();
+
+    //R1.01 Tuner view, drawn over the middle of the meter area.
+    bool Tuner_Show = false;
+    int Tuner_Last = -1;
+    void Mako_Tuner_Show(bool Show);
+
+    //R1.01 Adaptive quality tier last drawn.
+    int Tier_Last = 0;
 
 public:
     
     //R1.00 Define our SLIDER attachment variables.
-    std::unique_ptr <juce::AudioProcessorValueTreeState::SliderAttachment> ParAtt[20];
+    std::unique_ptr <juce::AudioProcessorValueTreeState::SliderAttachment> ParAtt[e_Knob_Count];
     
 };
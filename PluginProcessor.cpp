@@ -8,7 +8,20 @@
 
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
-#include "cmath"              //R1.00 Added library.
+#include "MakoTrace.h"          //R1.01 Stage trace markers, compile to nothing unless MAKO_TRACE=1.
+
+#if MAKO_AUDIT
+ #include <random>
+#endif
+
+//R1.01 Parameter IDs in MakoEngine parameter order. Density is saved with our state, it is not a parameter.
+static const char* Mako_Parm_ID[MakoEngine::e_Parm_Count] = {
+    "gain", "lowcut", "ngate", "drive", "comp1", "comp2", "low", "mid", "high",
+    "chain", "detpos", "detpeak", "detrms", "mono", "compbands", "limiter", "bypass", "quality", nullptr,
+    "dual", "dyneq", "dynthr_low", "dynthr_mid", "dynthr_high", "dynratio_low", "dynratio_mid", "dynratio_high",
+    "dynatk_low", "dynatk_mid", "dynatk_high", "dynrel_low", "dynrel_mid", "dynrel_high", "driveaa",
+    "gain_r", "lowcut_r", "ngate_r", "drive_r", "comp1_r", "comp2_r", "low_r", "mid_r", "high_r"
+};
 
 //==============================================================================
 MakoBiteAudioProcessor::MakoBiteAudioProcessor()
@@ -36,15 +49,84 @@ MakoBiteAudioProcessor::MakoBiteAudioProcessor()
         std::make_unique<juce::AudioParameterFloat>("low","Low", -12.0f, 12.0f, .0f),
         std::make_unique<juce::AudioParameterFloat>("mid","Mid", -12.0f, 12.0f, .0f),
         std::make_unique<juce::AudioParameterFloat>("high","High", -12.0f, 12.0f, .0f),
+
+        std::make_unique<juce::AudioParameterChoice>("chain","Signal Chain", juce::StringArray{ "LCut > Gate > EQ > Comp", "LCut > Gate > Comp > EQ", "Gate > LCut > EQ > Comp" }, 0),
+
+        std::make_unique<juce::AudioParameterChoice>("detpos","Detector Position", juce::StringArray{ "Input", "After Low Cut" }, 1),
+        std::make_unique<juce::AudioParameterFloat>("detpeak","Detector Peak Release", 1.0f, 200.0f, 10.0f),
+        std::make_unique<juce::AudioParameterFloat>("detrms","Detector RMS Time", 1.0f, 50.0f, 4.0f),
+
+        std::make_unique<juce::AudioParameterChoice>("mono","Mono Mode", juce::StringArray{ "Stereo", "Mono (Left In)", "Auto" }, 2),
+
+        std::make_unique<juce::AudioParameterChoice>("compbands","Comp Bands", juce::StringArray{ "1 Band", "2 Bands", "3 Bands", "4 Bands" }, 0),
+
+        std::make_unique<juce::AudioParameterChoice>("limiter","Output Limiter", juce::StringArray{ "Off (Clip)", "On (0.5 mS)", "On (1.5 mS)", "On (3 mS)", "On (5 mS)" }, 0),
+
+        std::make_unique<juce::AudioParameterBool>("bypass","Bypass", false),
+
+        std::make_unique<juce::AudioParameterChoice>("quality","Quality", juce::StringArray{ "Full", "Adaptive (10% CPU)", "Adaptive (25% CPU)", "Adaptive (50% CPU)" }, 0),
+
+        //R1.01 DUAL MONO. The right channel knobs, only used while dual is on.
+        std::make_unique<juce::AudioParameterBool>("dual","Dual Mono", false),
+        std::make_unique<juce::AudioParameterInt>("lowcut_r","Low Cut R", 20, 200, 10),
+        std::make_unique<juce::AudioParameterFloat>("ngate_r","Noise Gate R", .0f, 1.0f, .0f),
+        std::make_unique<juce::AudioParameterFloat>("comp1_r","Comp Thresh R", 0.0f, 1.0f, 1.0f),
+        std::make_unique<juce::AudioParameterFloat>("comp2_r","Comp Ratio R", 0.0f, 1.0f, 1.0f),
+        std::make_unique<juce::AudioParameterFloat>("gain_r","Gain R", .0f, 1.0f, .3162278f),
+        std::make_unique<juce::AudioParameterFloat>("drive_r","Drive R", .0f, 1.0f, .0f),
+        std::make_unique<juce::AudioParameterFloat>("low_r","Low R", -12.0f, 12.0f, .0f),
+        std::make_unique<juce::AudioParameterFloat>("mid_r","Mid R", -12.0f, 12.0f, .0f),
+        std::make_unique<juce::AudioParameterFloat>("high_r","High R", -12.0f, 12.0f, .0f),
+
+        //R1.01 DYNAMIC EQ. Threshold (dB), ratio and times (mS) of each EQ band's level detector.
+        std::make_unique<juce::AudioParameterBool>("dyneq","Dynamic EQ", false),
+        std::make_unique<juce::AudioParameterFloat>("dynthr_low","Dyn Low Thresh", -60.0f, 0.0f, -30.0f),
+        std::make_unique<juce::AudioParameterFloat>("dynratio_low","Dyn Low Ratio", 1.0f, 10.0f, 3.0f),
+        std::make_unique<juce::AudioParameterFloat>("dynatk_low","Dyn Low Attack", .1f, 50.0f, 2.0f),
+        std::make_unique<juce::AudioParameterFloat>("dynrel_low","Dyn Low Release", 10.0f, 500.0f, 80.0f),
+        std::make_unique<juce::AudioParameterFloat>("dynthr_mid","Dyn Mid Thresh", -60.0f, 0.0f, -30.0f),
+        std::make_unique<juce::AudioParameterFloat>("dynratio_mid","Dyn Mid Ratio", 1.0f, 10.0f, 3.0f),
+        std::make_unique<juce::AudioParameterFloat>("dynatk_mid","Dyn Mid Attack", .1f, 50.0f, 2.0f),
+        std::make_unique<juce::AudioParameterFloat>("dynrel_mid","Dyn Mid Release", 10.0f, 500.0f, 80.0f),
+        std::make_unique<juce::AudioParameterFloat>("dynthr_high","Dyn High Thresh", -60.0f, 0.0f, -30.0f),
+        std::make_unique<juce::AudioParameterFloat>("dynratio_high","Dyn High Ratio", 1.0f, 10.0f, 3.0f),
+        std::make_unique<juce::AudioParameterFloat>("dynatk_high","Dyn High Attack", .1f, 50.0f, 2.0f),
+        std::make_unique<juce::AudioParameterFloat>("dynrel_high","Dyn High Release", 10.0f, 500.0f, 80.0f),
+
+        //R1.01 DRIVE ANTI-ALIASING.
+        std::make_unique<juce::AudioParameterChoice>("driveaa","Drive Anti-Alias", juce::StringArray{ "Off", "ADAA 1st Order", "ADAA 2nd Order" }, 0),
       }
     )   
 
 #endif
 {   
+    //R1.01 Hand every parameter to the engine and listen for changes.
+    for (int t = 0; t < MakoEngine::e_Parm_Count; t++)
+    {
+        if (Mako_Parm_ID[t] == nullptr) continue;
+        Parm_Raw[t] = parameters.getRawParameterValue(Mako_Parm_ID[t]);
+        Mako_Parm_Forward(t);
+        Parm_Listen[t].Owner = this;
+        Parm_Listen[t].Id = t;
+        parameters.addParameterListener(Mako_Parm_ID[t], &Parm_Listen[t]);
+    }
+
+#if MAKO_AUDIT
+    if (std::getenv("MAKO_AUDIT_STRESS") != nullptr) Audit_Stress = std::thread([this] { Mako_Audit_Stress(); });
+#endif
 }
 
 MakoBiteAudioProcessor::~MakoBiteAudioProcessor()
 {
+#if MAKO_AUDIT
+    Audit_Quit = true;
+    if (Audit_Stress.joinable()) Audit_Stress.join();
+#endif
+
+    //R1.01 Stop listening before we go away.
+    for (int t = 0; t < MakoEngine::e_Parm_Count; t++)
+        if (Mako_Parm_ID[t] != nullptr) parameters.removeParameterListener(Mako_Parm_ID[t], &Parm_Listen[t]);
+    cancelPendingUpdate();
 }
 
 //==============================================================================
@@ -115,23 +197,19 @@ void MakoBiteAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlo
     // Use this method as the place to do any pre-playback
     // initialisation that you need..
 
-    //R1.00 Get our Sample Rate for filter calculations.
-    SampleRate = MakoBiteAudioProcessor::getSampleRate();
-    if (SampleRate < 21000) SampleRate = 48000;
-    if (192000 < SampleRate) SampleRate = 48000;
+    //R1.01 The limiter may still be waiting for handleAsyncUpdate. Nothing is playing, so it can go straight in.
+    Mako_Parm_Forward(MakoEngine::e_Parm_Limiter);
 
-    //R1.00 Calculate some rough decay subtraction values for peak tracking (compress,autowah,etc). 
-    Release_5mS = (1.0f / .005f) * (1.0f / SampleRate);
-    Release_10mS = (1.0f / .010f) * (1.0f / SampleRate);
-    Release_50mS = (1.0f / .05f) * (1.0f / SampleRate);
-    Release_100mS = (1.0f / .100f) * (1.0f / SampleRate);
-    Release_200mS = (1.0f / .200f) * (1.0f / SampleRate);
-    Release_300mS = (1.0f / .300f) * (1.0f / SampleRate);  
-    Release_400mS = (1.0f / .400f) * (1.0f / SampleRate); 
-    Release_500mS = (1.0f / .500f) * (1.0f / SampleRate); 
+    //R1.01 The engine redoes everything for the new sample rate, then we report its latency.
+    Engine.Prepare(sampleRate, samplesPerBlock, juce::jmin(2, getTotalNumInputChannels()));
+    setLatencySamples(Engine.GetLatency());
 
-    //R1.00 Update the adjustable values and filters. 
-    Mako_Settings_Update(true);
+    //R1.01 The tuner decimates from our sample rate.
+    Tuner.SetSampleRate(Engine.GetSampleRate());
+
+    //R1.01 Our cab IR has to be at the new sample rate. Loading it is message thread work.
+    IR_Reload = true;
+    triggerAsyncUpdate();
 }
 
 void MakoBiteAudioProcessor::releaseResources()
@@ -168,16 +246,11 @@ bool MakoBiteAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
 
 void MakoBiteAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
-    juce::ScopedNoDenormals noDenormals;
+    MAKO_TRACE_SCOPE("processBlock");
+    MAKO_AUDIT_SCOPE("processBlock");
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
-    //R1.00 Our defined variables.
-    float tS;  //R1.00 Temporary Sample.
-
-    //R1.00 Handle any changes to our Parameters made in the editor/DAW.
-    if (0 < SettingsChanged) Mako_Settings_Update(false);
-
     // In case we have more outputs than inputs, this code clears any output
     // channels that didn't contain input data, (because these aren't
     // guaranteed to be empty - they may contain garbage).
@@ -187,48 +260,140 @@ void MakoBiteAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juc
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
-    // This is the place where you'd normally do the guts of your plugin's
-    // audio processing...
-    // Make sure to reset the state if your inner loop is processing
-    // the samples and the outer loop is handling the channels.
-    // Alternatively, you can process the samples with the channels
-    // interleaved by keeping the same state.
-    for (int channel = 0; channel < totalNumInputChannels; ++channel)
+    //R1.01 The tuner gets a copy of the raw input. Does nothing unless the tuner is showing.
+    Tuner.Push(buffer.getReadPointer(0), buffer.getNumSamples());
+
+    //R1.01 Everything else is the engine. It flushes denormals itself.
+    Engine.Process(buffer.getArrayOfWritePointers(), buffer.getNumSamples());
+}
+
+//R1.01 Hosts that bypass us themselves still get the crossfade and the latency lined up.
+void MakoBiteAudioProcessor::processBlockBypassed(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    Engine.Host_Bypass = true;
+    processBlock(buffer, midiMessages);
+    Engine.Host_Bypass = false;
+}
+
+juce::AudioProcessorParameter* MakoBiteAudioProcessor::getBypassParameter() const
+{
+    return parameters.getParameter("bypass");
+}
+
+#if MAKO_AUDIT
+//R1.01 Audit stress driver. Acts like very busy automation plus a user on the knobs: a random parameter
+//R1.01 goes to a random value every 2 mS, often straight to either end of its range.
+//R1.01 High density mode is flipped now and then.
+void MakoBiteAudioProcessor::Mako_Audit_Stress()
+{
+    std::mt19937 Rand(12345);
+    std::uniform_real_distribution<float> Value(0.0f, 1.0f);
+    auto& Parms = getParameters();
+    int Moves = 0;
+
+    while (!Audit_Quit.load() && (0 < Parms.size()))
     {
-        auto* channelData = buffer.getWritePointer (channel);
-        
-        // ..do something to the data...
-        for (int samp = 0; samp < buffer.getNumSamples(); samp++)
-        {
-            //R1.00 Get the current sample and put it in tS. 
-            tS = buffer.getSample(channel, samp);
+        auto* Parm = dynamic_cast<juce::RangedAudioParameter*>(Parms[int(Rand() % unsigned(Parms.size()))]);
+        float v = Value(Rand);
+        if (v < .1f) v = 0.0f;
+        if (.9f < v) v = 1.0f;
 
-            //R1.00 Track our loudest INPUT signal.
-            if (VUValue[channel] < abs(tS)) VUValue[channel] = abs(tS);
+        if (Parm != nullptr) Parm->setValueNotifyingHost(v);
 
-            //R1.00 Apply Low Cut Filter if being used.
-            if (20.0f < Setting[e_LowCut]) tS = Filter_Calc_BiQuad(tS, channel, &makoF_LowCut);
+        if ((++Moves % 500) == 0) Mako_Density_Set(!Mako_Density_Get());
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+}
+#endif
 
-            //R1.00 Apply Noise gate if being used.
-            if (0.0f < Setting[e_NGate]) tS = Mako_FX_NoiseGate(tS, channel);
+//R1.01 Parameters can change on any thread, even the audio thread during automation.
+//R1.01 The engine only flags the change, so everything goes straight in except the limiter,
+//R1.01 which changes our latency and waits for the message thread.
+void MakoBiteAudioProcessor::Mako_Parm_Changed(int Id, float Value)
+{
+    if (Id == MakoEngine::e_Parm_Limiter)
+        triggerAsyncUpdate();
+    else
+        Engine.SetParam(Id, Value);
+}
 
-            //R1.00 Apply our EQ and gain to the sample. 
-            tS = Mako_FX_EQandGain(tS, channel);
+//R1.01 Copy one parameter's current value into the engine.
+void MakoBiteAudioProcessor::Mako_Parm_Forward(int Id)
+{
+    if (Parm_Raw[Id] != nullptr) Engine.SetParam(Id, Parm_Raw[Id]->load());
+}
 
-            //R1.00 Compressor. Could be here or before gain.
-            if (Setting[e_Comp1] < 1.0f) tS = Mako_FX_Compressor(tS, channel);
-            
-            //R1.00 Clip and track the loudest OUTPUT signal so far.
-            if (1.0f < tS) tS = 1.0f;
-            if (tS < -1.0f) tS = -1.0f;
-            if (VUValue[channel + 2] < abs(tS)) VUValue[channel + 2] = abs(tS);
+//R1.01 Message thread. Report the latency of the limiter setting before the engine switches to it,
+//R1.01 so the host is never behind the audio thread. Then load a cab IR restored with our settings.
+void MakoBiteAudioProcessor::handleAsyncUpdate()
+{
+    int Mode = Mako_GetParmValue_int("limiter");
+    setLatencySamples(Engine.GetLatency(Mode));
+    Mako_Parm_Forward(MakoEngine::e_Parm_Limiter);
 
-            //R1.00 Write our modified sample into the buffer.
-            channelData[samp] = tS;
+    //R1.01 Only reload if the IR we have is not that file at our sample rate.
+    if (IR_Reload.exchange(false))
+    {
+        juce::String Path = Mako_IR_Wanted();
+        const MakoIR* IR = Engine.Mako_IR_Get();
+        if (Path.isEmpty())
+            Mako_IR_Clear();
+        else if ((IR == nullptr) || (IR->Key != Path.toStdString()) || (IR->SampleRate != Engine.GetSampleRate()))
+            Mako_IR_Load(juce::File(Path));
+    }
+}
 
-        }
-       
+//R1.01 Load a cab IR file. Multi channel IRs are mixed to mono. The resampled and partitioned IR is
+//R1.01 shared by every instance, so only the first instance to load a file at a sample rate does the work.
+bool MakoBiteAudioProcessor::Mako_IR_Load(const juce::File& File)
+{
+    std::string Key = File.getFullPathName().toStdString();
+    double Rate = Engine.GetSampleRate();
+    auto IR = MakoIR_Find(Key, Rate);
+
+    if (IR == nullptr)
+    {
+        juce::AudioFormatManager Formats;
+        Formats.registerBasicFormats();
+        std::unique_ptr<juce::AudioFormatReader> Reader(Formats.createReaderFor(File));
+        if ((Reader == nullptr) || (Reader->sampleRate <= 0.0) || (Reader->numChannels < 1)) return false;
+
+        //R1.01 The IR is cut to one second after resampling, so there is no point reading more than that.
+        int Count = int(juce::jmin<juce::int64>(Reader->lengthInSamples, juce::int64(Reader->sampleRate) + 1));
+        int Chans = int(Reader->numChannels);
+        juce::AudioBuffer<float> Buf(Chans, Count);
+        Reader->read(&Buf, 0, Count, 0, true, true);
+
+        for (int channel = 1; channel < Chans; channel++) Buf.addFrom(0, 0, Buf, channel, 0, Count);
+        Buf.applyGain(0, 0, Count, 1.0f / float(Chans));
+
+        IR = MakoIR_Build(Key, Buf.getReadPointer(0), Count, Reader->sampleRate, Rate);
     }
+
+    Engine.Mako_IR_Set(IR);
+    IR_Path = File.getFullPathName();
+    Mako_IR_Want(IR_Path);
+    return true;
+}
+
+void MakoBiteAudioProcessor::Mako_IR_Clear()
+{
+    Engine.Mako_IR_Set(nullptr);
+    IR_Path.clear();
+    Mako_IR_Want(IR_Path);
+}
+
+//R1.01 The path we should have loaded, saved with our settings. Any thread.
+void MakoBiteAudioProcessor::Mako_IR_Want(const juce::String& Path)
+{
+    std::lock_guard<std::mutex> Lock(IR_Lock);
+    IR_Want = Path;
+}
+
+juce::String MakoBiteAudioProcessor::Mako_IR_Wanted()
+{
+    std::lock_guard<std::mutex> Lock(IR_Lock);
+    return IR_Want;
 }
 
 //==============================================================================
@@ -252,6 +417,9 @@ void MakoBiteAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
     
     //R1.00 Save our parameters to file/DAW.
     auto state = parameters.copyState();
+    state.setProperty("uiscale", UI_Scale, nullptr);
+    state.setProperty("density", Mako_Density_Get(), nullptr);
+    state.setProperty("irpath", Mako_IR_Wanted(), nullptr);
     std::unique_ptr<juce::XmlElement> xml(state.createXml());
     copyXmlToBinary(*xml, destData);
    
@@ -269,16 +437,20 @@ void MakoBiteAudioProcessor::setStateInformation (const void* data, int sizeInBy
         if (xmlState->hasTagName(parameters.state.getType()))
             parameters.replaceState(juce::ValueTree::fromXml(*xmlState));
 
+    //R1.01 Restore the editor window size.
+    UI_Scale = parameters.state.getProperty("uiscale", 1.0f);
+    Mako_Density_Set(bool(parameters.state.getProperty("density", false)));
+
+    //R1.01 Reload the cab IR on the message thread, hosts may call us from anywhere.
+    //R1.01 IR_Path belongs to the message thread, the path goes thru the locked slot.
+    Mako_IR_Want(parameters.state.getProperty("irpath", juce::String()).toString());
+    IR_Reload = true;
+    triggerAsyncUpdate();
+
     //R1.00 Force our variables to get updated.
-    Setting[e_Gain] = Mako_GetParmValue_float("gain");
-    Setting[e_LowCut] = Mako_GetParmValue_float("lowcut");
-    Setting[e_NGate] = Mako_GetParmValue_float("ngate");    
-    Setting[e_Drive] = Mako_GetParmValue_float("drive");
-    Setting[e_Comp1] = Mako_GetParmValue_float("comp1");
-    Setting[e_Comp2] = Mako_GetParmValue_float("comp2");
-    Setting[e_Low] = Mako_GetParmValue_float("low");
-    Setting[e_Mid] = Mako_GetParmValue_float("mid");
-    Setting[e_High] = Mako_GetParmValue_float("high");
+    //R1.01 The limiter follows in handleAsyncUpdate, with its latency.
+    for (int t = 0; t < MakoEngine::e_Parm_Count; t++)
+        if (t != MakoEngine::e_Parm_Limiter) Mako_Parm_Forward(t);
 }
 
 //R1.00 Parameter reading helper function.
@@ -301,21 +473,6 @@ float MakoBiteAudioProcessor::Mako_GetParmValue_float(juce::String Pstring)
         return 0.0f;
 }
 
-//R1.00 Volume envelope based on average Signal volume.
-float MakoBiteAudioProcessor::Mako_FX_NoiseGate(float tSample, int channel)
-{
-    //R1.00 Track our Input Signal Average (Absolute vals).
-    Signal_AVG[channel] = (Signal_AVG[channel] * .995) + (abs(tSample) * .005);
-
-    //R1.00 Create a volume envelope based on Signal Average.
-    Pedal_NGate_Fac[channel] = Signal_AVG[channel] * 10000.0f * (1.1f - Setting[e_NGate]);
-
-    //R1.00 Dont amplify the sound, just reduce when necessary.
-    if (1.0f < Pedal_NGate_Fac[channel]) Pedal_NGate_Fac[channel] = 1.0f;
-
-    return tSample * Pedal_NGate_Fac[channel];
-}
-
 
 //==============================================================================
 // This creates new instances of the plugin..
@@ -323,142 +480,3 @@ juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
 {
     return new MakoBiteAudioProcessor();
 }
-
-//R1.00 Apply filter to a sample.
-float MakoBiteAudioProcessor::Filter_Calc_BiQuad(float tSample, int channel, tp_filter* fn)
-{
-    float tS = tSample;
-
-    fn->xn0[channel] = tS;
-    tS = fn->a0 * fn->xn0[channel] + fn->a1 * fn->xn1[channel] + fn->a2 * fn->xn2[channel] - fn->b1 * fn->yn1[channel] - fn->b2 * fn->yn2[channel];
-    fn->xn2[channel] = fn->xn1[channel]; fn->xn1[channel] = fn->xn0[channel]; fn->yn2[channel] = fn->yn1[channel]; fn->yn1[channel] = tS;
-
-    return tS;
-}
-
-//R1.00 Second order parametric/peaking boost filter with constant-Q
-void MakoBiteAudioProcessor::Filter_BP_Coeffs(float Gain_dB, float Fc, float Q, tp_filter* fn)
-{    
-    float K = pi2 * (Fc * .5f) / SampleRate;
-    float K2 = K * K;
-    float V0 = pow(10.0, Gain_dB / 20.0);
-
-    float a = 1.0f + (V0 * K) / Q + K2;
-    float b = 2.0f * (K2 - 1.0f);
-    float g = 1.0f - (V0 * K) / Q + K2;
-    float d = 1.0f - K / Q + K2;
-    float dd = 1.0f / (1.0f + K / Q + K2);
-
-    fn->a0 = a * dd;
-    fn->a1 = b * dd;
-    fn->a2 = g * dd;
-    fn->b1 = b * dd;
-    fn->b2 = d * dd;
-    fn->c0 = 1.0f;
-    fn->d0 = 0.0f;
-}
-
-//R1.00 Second order butterworth LOW PASS filter. 
-void MakoBiteAudioProcessor::Filter_LP_Coeffs(float fc, tp_filter* fn)
-{    
-    float c = 1.0f / (tanf(pi * fc / SampleRate));
-    fn->a0 = 1.0f / (1.0f + sqrt2 * c + (c * c));
-    fn->a1 = 2.0f * fn->a0;
-    fn->a2 = fn->a0;
-    fn->b1 = 2.0f * fn->a0 * (1.0f - (c * c));
-    fn->b2 = fn->a0 * (1.0f - sqrt2 * c + (c * c));
-}
-
-//R1.00 Second order butterworth HIGH PASS filter.
-void MakoBiteAudioProcessor::Filter_HP_Coeffs(float fc, tp_filter* fn)
-{    
-    float c = tanf(pi * fc / SampleRate);
-    fn->a0 = 1.0f / (1.0f + sqrt2 * c + (c * c));
-    fn->a1 = -2.0f * fn->a0;
-    fn->a2 = fn->a0;
-    fn->b1 = 2.0f * fn->a0 * ((c * c) - 1.0f);
-    fn->b2 = fn->a0 * (1.0f - sqrt2 * c + (c * c));
-}
-
-//R1.00 Apply some EQ and gain to the sample.
-float MakoBiteAudioProcessor::Mako_FX_EQandGain(float tSample, int channel)
-{
-    float tS = tSample;
-    
-    //R1.00 Apply our 3-band EQ to the signal.
-    if (0.0f != Setting[e_Low]) tS = Filter_Calc_BiQuad(tS, channel, &makoF_Low);
-    if (0.0f != Setting[e_Mid]) tS = Filter_Calc_BiQuad(tS, channel, &makoF_Mid);
-    if (0.0f != Setting[e_High]) tS = Filter_Calc_BiQuad(tS, channel, &makoF_High);
-
-    //R1.00 Apply some gain/drive/distortion.
-    if (0.0f < Setting[e_Drive]) tS = tanhf(tS * (.1f + Setting[e_Drive]) * 6.0f);
-
-    //R1.00 Volume/Gain adjust.
-    return Setting[e_Gain] * Setting[e_Gain] * tS * 10.0f;
-}
-
-//R1.00 MAKO COMPRESSOR - Try to limit guitar dynamic range.
-float MakoBiteAudioProcessor::Mako_FX_Compressor(float tSample, int channel)
-{
-    //R1.00 The compressor needs Threshold, Ratio, Attack, and Release vars.
-    //R1.00 We are using fixed vals for all but Ratio. Should be more knobs on screen.
-    //R1.00 Could add advanced features like increase Release time if we are in compression for a long time.
-    float diff;
-    float tSa = abs(tSample);
-    float Thresh = Setting[e_Comp1];  //R1.00 Compressor Threshold.
-    float Ratio = Setting[e_Comp2];   //R1.00 Compressor RATIO.
-
-    //R1.00 If our signal is above the Threshold we need to start compressing.
-    if (Thresh < tSa)
-    {
-        //R1.00 Get Difference in Gain and Threshold.    
-        diff = tSa - Thresh;
-
-        //R1.00 Calc what our new gain reduction value should be.
-        Pedal_CompGain[channel] = (Thresh + (diff * Ratio)) / tSa;
-
-        //R1.00 Slowly modify our GAIN adjuster to the new gain value. 
-        if (Pedal_CompGain[channel] < Pedal_CompGainAdj[channel])
-        {
-            //R1.00 To have a comp attack we need a 2nd var that we adjust up to the actual max. So the comp slowly begins working.
-            //R1.00 ATTACK - Slowly reduce the gain to the desired value.
-            Pedal_CompGainAdj[channel] -= Release_5mS; 
-            if (Pedal_CompGainAdj[channel] < 0.0f) Pedal_CompGainAdj[channel] = 0.0f;
-        }
-        else
-        {
-            //R1.00 RELEASE - Adjust the gain back up to 1.0f.
-            Pedal_CompGainAdj[channel] += Release_50mS;
-            if (1.0f < Pedal_CompGainAdj[channel]) Pedal_CompGainAdj[channel] = 1.0f;
-        }
-    }
-    else
-    {
-        //R1.00 Signal is BELOW the threshold, stop compressing and RELEASE - Adjust the gain back up to 1.0f.
-        Pedal_CompGainAdj[channel] += Release_50mS;
-        if (1.0f < Pedal_CompGainAdj[channel]) Pedal_CompGainAdj[channel] = 1.0f;
-    }
-
-    return tSample * Pedal_CompGainAdj[channel];    
-}
-
-
-void MakoBiteAudioProcessor::Mako_Settings_Update(bool ForceAll)
-{
-    //R1.00 We do changes here so we know the vars are not in use while we change them.
-    //R1.00 EDITOR sets SETTING flags and we make changes here.
-    //R1.00 If there are any settings
-    bool Force = ForceAll;
-
-    //R1.00 Update our EQ Filters.
-    Filter_HP_Coeffs(Setting[e_LowCut], &makoF_LowCut);
-    Filter_BP_Coeffs(Setting[e_Low], 450.0f, .707f, &makoF_Low);
-    Filter_BP_Coeffs(Setting[e_Mid], 750.0f, .707f, &makoF_Mid);
-    Filter_BP_Coeffs(Setting[e_High], 1500.0f, .707f, &makoF_High);
-
-    //R1.00 RESET out settings flags.
-    SettingsType = 0;
-    SettingsChanged = false;
-}
-
-
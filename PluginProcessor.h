@@ -9,11 +9,14 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "MakoEngine.h"        //R1.01 The DSP chain, plain C++.
+#include "MakoTuner.h"         //R1.01 Built in tuner.
+#include "MakoAudit.h"         //R1.01 Realtime safety audit, compiles to nothing unless MAKO_AUDIT=1.
 
 //==============================================================================
 /**
 */
-class MakoBiteAudioProcessor  : public juce::AudioProcessor
+class MakoBiteAudioProcessor  : public juce::AudioProcessor, public juce::AsyncUpdater
                             #if JucePlugin_Enable_ARA
                              , public juce::AudioProcessorARAExtension
                             #endif
@@ -33,6 +36,10 @@ public:
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
 
+    //R1.01 BYPASS. Hosts switch our "bypass" parameter, or call processBlockBypassed. Either way we crossfade.
+    void processBlockBypassed (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    juce::AudioProcessorParameter* getBypassParameter() const override;
+
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
     bool hasEditor() const override;
@@ -56,105 +63,72 @@ public:
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
 
+    //R1.01 Message thread callback. Used to rebuild things off the audio thread.
+    void handleAsyncUpdate() override;
+
     //R1.00 Add a Parameters variable.
     juce::AudioProcessorValueTreeState parameters;                           
     
-    //R1.00 Settings variables.
-    int SettingsChanged = 0;
-    int SettingsType = 0;
-    float Setting[30] = {};
-    float Setting_Last[30] = {};
-
-    //R1.00 Our signal level values. 
-    // 0=Input L, 1=Input R, 2=Output L, 3=Output R
-    float VUValue[4] = {};
-    
-    //R1.00 Our public variables.
-    float Pedal_NGate_Fac[2] = {};    //R1.00 Noise Gate.
-    float Signal_AVG[2] = {};       
-    
-    float Pedal_CompGain[2] = {};     //R1.00 Compressor vars.
-    float Pedal_CompGainAdj[2] = {};
+    //R1.01 The DSP ENGINE. We are only the adapter: parameters go in thru Mako_Parm_Changed,
+    //R1.01 audio thru processBlock. The editor reads the meters straight from it.
+    MakoEngine Engine;
+
+    //R1.00 These are the indexes into our Settings var.
+    enum { e_Gain, e_LowCut, e_NGate, e_Drive, e_Comp1, e_Comp2, e_Low, e_Mid, e_High, e_Setting_Count };
+    //R1.01 Side 1 is the right channel knobs of DUAL MONO.
+    float Mako_GetSetting(int t, int Side = 0) const { return Engine.GetParam((Side == 0) ? t : MakoEngine::e_Parm_Right + t); }
 
-  
-        
+    //R1.01 Editor window size compared to the original 490 x 130. Saved with our settings.
+    float UI_Scale = 1.0f;
+
+    //R1.01 HIGH DENSITY mode for sessions with hundreds of instances. Saved with our settings.
+    //R1.01 Filters use the coefficient tables shared by all instances, and metering is
+    //R1.01 skipped while our editor is closed.
+    bool Mako_Density_Get() const { return .5f <= Engine.GetParam(MakoEngine::e_Parm_Density); }
+    void Mako_Density_Set(bool On) { Engine.SetParam(MakoEngine::e_Parm_Density, On ? 1.0f : 0.0f); }
+
+    //R1.01 CAB IR. Load an impulse response file for the cabinet stage, or turn it off.
+    //R1.01 Message thread only, IR_Path too (the file loaded). The path is saved with our settings.
+    bool Mako_IR_Load(const juce::File& File);
+    void Mako_IR_Clear();
+    juce::String IR_Path;
+
+    //R1.01 TUNER. The editor starts it when the tuner is shown and stops it when hidden.
+    MakoTuner Tuner;
 
 private:
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MakoBiteAudioProcessor)
-   
-    //R1.00 These are the indexes into our Settings var.
-    enum { e_Gain, e_LowCut, e_NGate, e_Drive, e_Comp1, e_Comp2, e_Low, e_Mid, e_High };
+
+    //R1.01 Parameter IDs in engine parameter order. Each parameter gets its own listener that knows its
+    //R1.01 engine index, so a change goes straight to the engine without any String compare.
+    //R1.01 The limiter goes to the engine from the message thread, after the host has the new latency.
+    struct tp_parmlisten : public juce::AudioProcessorValueTreeState::Listener
+    {
+        MakoBiteAudioProcessor* Owner = nullptr;
+        int Id = 0;
+        void parameterChanged(const juce::String&, float newValue) override { Owner->Mako_Parm_Changed(Id, newValue); }
+    };
+    tp_parmlisten Parm_Listen[MakoEngine::e_Parm_Count];
+    void Mako_Parm_Changed(int Id, float Value);
+    void Mako_Parm_Forward(int Id);
+    std::atomic<float>* Parm_Raw[MakoEngine::e_Parm_Count] = {};
+    std::atomic<bool> IR_Reload{ false };
+
+    //R1.01 The cab IR path we should have. Set from any thread (restoring settings), loaded on the message thread.
+    void Mako_IR_Want(const juce::String& Path);
+    juce::String Mako_IR_Wanted();
+    std::mutex IR_Lock;
+    juce::String IR_Want;
+
+#if MAKO_AUDIT
+    //R1.01 Audit STRESS driver (MAKO_AUDIT_STRESS=1). Moves every parameter at random from a background thread.
+    std::thread Audit_Stress;
+    std::atomic<bool> Audit_Quit{ false };
+    void Mako_Audit_Stress();
+#endif
 
     //R1.00 Clean up the parameter reading code.
     int Mako_GetParmValue_int(juce::String Pstring);
     float Mako_GetParmValue_float(juce::String Pstring);
-
-    //R1.00 Handle parameter changes made in editor.
-    void Mako_Settings_Update(bool ForceAll);
-    
-    //R1.00 Our actual AUDIO adjusting functions.
-    float Mako_FX_NoiseGate(float tSample, int channel);
-    float Mako_FX_Compressor(float tSample, int channel);
-    float Mako_FX_EQandGain(float tSample, int channel);
-    
-    //R1.00 Some Constants and vars.
-    const float pi = 3.14159265f;
-    const float pi2 = 6.2831853f;
-    const float sqrt2 = 1.4142135f;
-    float SampleRate = 48000.0f;
-
-    //R1.00 Calc some times based on sample rate for compressors, etc.
-    float Release_5mS = 0.0f;
-    float Release_10mS = 0.0f;
-    float Release_50mS = 0.0f;
-    float Release_100mS = 0.0f;
-    float Release_200mS = 0.0f;
-    float Release_300mS = 0.0f;
-    float Release_400mS = 0.0f;
-    float Release_500mS = 0.0f;
-
-    //R1.00 OUR FILTER VARIABLES
-    struct tp_coeffs {
-        float a0;
-        float a1;
-        float a2;
-        float b1;
-        float b2;
-        float c0;
-        float d0;
-    };
-
-    struct tp_filter {
-        float a0;
-        float a1;
-        float a2;
-        float b1;
-        float b2;
-        float c0;
-        float d0;
-        float xn0[2];
-        float xn1[2];
-        float xn2[2];
-        float yn1[2];
-        float yn2[2];
-        float offset[2];
-    };
-
-    //R1.00 FILTER FUNCTIONS
-    float Filter_Calc_BiQuad(float tSample, int channel, tp_filter* fn);
-    void Filter_BP_Coeffs(float Gain_dB, float Fc, float Q, tp_filter* fn);
-    void Filter_LP_Coeffs(float fc, tp_filter* fn);
-    void Filter_HP_Coeffs(float fc, tp_filter* fn);    
-
-    //R1.00 Our pedal filters and function def.
-    tp_filter makoF_LowCut = {};
-    tp_filter makoF_Low = {};
-    tp_filter makoF_Mid = {};
-    tp_filter makoF_High = {};
-    
-    
-        
-    
-
 };
@@ -0,0 +1,393 @@
+/*
+  ==============================================================================
+
+    MakoSessionBench.cpp
+    R1.01 SESSION BENCHMARK. Many instances at once, the way a big session runs us.
+
+    One instance in a loop has the caches to itself. A session has 100+ of us
+    spread over the host's worker threads, every one with its own state. This
+    builds N MakoEngine instances with varied settings (drive, compressor
+    bands, chain order, limiter, dual mono, dynamic EQ, drive anti-aliasing,
+    shared cab IRs, mono and stereo inputs) and runs them like a host does:
+    every block period all N must be done, the worker threads take instances
+    from a shared counter, and a block is late if the last one finishes after
+    the period. Blocks run back to back, so the deadline is the only budget.
+
+    Reports, for each thread count:
+    * Deadline misses, and the block period time p50/p99/p999/max.
+    * Single instance Process times p50/p99/p999/max.
+    * Instances per second and the scaling efficiency against 1 thread.
+    And once: heap per instance (shared cab IRs counted apart), and any heap
+    allocations made on the worker threads (there must be none).
+
+    Not part of the plugin, it has its own main(). From the repo folder:
+
+        g++ -std=c++17 -O3 -I. tools/MakoSessionBench.cpp MakoEngine.cpp MakoKernels.cpp MakoKernels_AVX2.cpp
+            MakoKernels_AVX512.cpp MakoLimiter.cpp MakoTruePeak.cpp MakoConvolver.cpp -lpthread -o MakoSessionBench
+
+    Visual C++: the same files in a console project, with /arch:AVX2 and /arch:AVX512 set on the two
+    kernel files as in the plugin.
+
+        MakoSessionBench [-n instances] [-t threads] [-b block] [-r rate] [-s seconds] [-seed n] [-scale]
+
+    -t is the most threads used (default: all cores). With -scale every count from 1 up is run
+    (1, 2, 4 ... and the most), otherwise only the most. MAKO_KERNELS picks the kernel path as usual.
+
+  ==============================================================================
+*/
+
+#include "MakoEngine.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+//R1.01 HEAP COUNTING. Every allocation keeps its size in front of it, so the live total is exact.
+//R1.01 Bench_Audio is set on the worker threads while they run blocks, any allocation there is counted.
+static std::atomic<int64_t> Heap_Live{ 0 };
+static std::atomic<int64_t> Heap_Audio{ 0 };
+static thread_local bool Bench_Audio = false;
+
+struct tp_heaphead {
+    void* Raw;
+    size_t Size;
+};
+
+static void* Bench_Alloc(size_t Size, size_t Align)
+{
+    Align = std::max(Align, alignof(std::max_align_t));
+    size_t Head = (sizeof(tp_heaphead) + Align - 1) / Align * Align;
+    void* Raw = malloc(Size + Head + Align);
+    if (Raw == nullptr) throw std::bad_alloc();
+
+    uintptr_t p = (reinterpret_cast<uintptr_t>(Raw) + Head + Align - 1) & ~uintptr_t(Align - 1);
+    tp_heaphead* H = reinterpret_cast<tp_heaphead*>(p) - 1;
+    H->Raw = Raw;
+    H->Size = Size;
+    Heap_Live.fetch_add(int64_t(Size), std::memory_order_relaxed);
+    if (Bench_Audio) Heap_Audio.fetch_add(1, std::memory_order_relaxed);
+    return reinterpret_cast<void*>(p);
+}
+
+static void Bench_Free(void* p)
+{
+    if (p == nullptr) return;
+    tp_heaphead* H = static_cast<tp_heaphead*>(p) - 1;
+    Heap_Live.fetch_sub(int64_t(H->Size), std::memory_order_relaxed);
+    free(H->Raw);
+}
+
+void* operator new(size_t Size) { return Bench_Alloc(Size, alignof(std::max_align_t)); }
+void* operator new(size_t Size, std::align_val_t Align) { return Bench_Alloc(Size, size_t(Align)); }
+void operator delete(void* p) noexcept { Bench_Free(p); }
+void operator delete(void* p, size_t) noexcept { Bench_Free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { Bench_Free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { Bench_Free(p); }
+
+//R1.01 Small repeatable random numbers, so -seed gives the same session every time.
+struct tp_random {
+    uint32_t State;
+    uint32_t Next() { State = State * 1664525u + 1013904223u; return State >> 8; }
+    float Uniform() { return float(Next()) / 16777216.0f; }
+    int Pick(int Count) { return int(Next() % uint32_t(Count)); }
+    bool Chance(float p) { return Uniform() < p; }
+};
+
+//R1.01 One instance: the engine, its own in/out buffers and where it reads the source from.
+struct tp_instance {
+    std::unique_ptr<MakoEngine> Engine;
+    std::vector<float> Buffer[2];
+    float* Data[2] = {};
+    bool Mono = false;
+    int Offset = 0;
+};
+
+//R1.01 Settings for instance i. Roughly what a session of guitar tracks and busses looks like.
+static MakoEngine::tp_params Bench_Params(tp_random& R)
+{
+    MakoEngine::tp_params P;
+    P.Gain = .1f + .5f * R.Uniform();
+    P.LowCut = R.Chance(.5f) ? 20.0f + 180.0f * R.Uniform() : 20.0f;
+    P.NGate = R.Chance(.4f) ? .2f * R.Uniform() : 0.0f;
+    P.Drive = R.Chance(.7f) ? R.Uniform() : 0.0f;
+    P.Comp_Thresh = R.Chance(.6f) ? .2f + .7f * R.Uniform() : 1.0f;
+    P.Comp_Ratio = R.Uniform();
+    P.Low = float(R.Pick(25) - 12);
+    P.Mid = float(R.Pick(25) - 12);
+    P.High = float(R.Pick(25) - 12);
+    P.Chain = R.Pick(MakoEngine::e_Chain_Count);
+    P.DetPos = R.Pick(MakoEngine::e_DetPos_Count);
+    P.CompBands = 1 + R.Pick(4);
+    P.Limiter = R.Pick(MakoEngine::e_Limit_Count);
+    P.Density = R.Chance(.5f);
+    P.DynEQ = R.Chance(.25f);
+    P.DriveAA = R.Pick(MakoEngine::e_DriveAA_Count);
+    P.Dual = R.Chance(.15f);
+    if (P.Dual)
+        for (int t = 0; t < MakoEngine::e_Setting_Count; t++) P.Right[t] = (t < MakoEngine::e_Low) ? P.Right[t] : float(R.Pick(25) - 12);
+    return P;
+}
+
+//R1.01 The source every instance reads from, at its own offset: plucked notes with a few harmonics.
+static std::vector<float> Bench_Source(double Rate, int Seconds)
+{
+    std::vector<float> Src(size_t(Rate * Seconds));
+    static const float Notes[6] = { 82.4f, 110.0f, 146.8f, 196.0f, 246.9f, 329.6f };
+    int Note = int(Rate / 4);
+    for (size_t i = 0; i < Src.size(); i++)
+    {
+        size_t Start = i / size_t(Note) * size_t(Note);
+        float f = Notes[(i / size_t(Note)) % 6];
+        float t = float(i - Start) / float(Rate);
+        float Env = expf(-3.0f * t);
+        float x = 0.0f;
+        for (int h = 1; h <= 5; h++) x += sinf(6.2831853f * f * h * t) / float(h);
+        Src[i] = .4f * Env * x;
+    }
+    return Src;
+}
+
+//R1.01 A made up cab IR: decaying noise thru a one pole low pass. Built once, shared like a real cab file.
+static std::shared_ptr<const MakoIR> Bench_IR(const char* Key, double Rate, float Length_S, uint32_t Seed)
+{
+    tp_random R{ Seed };
+    std::vector<float> IR(size_t(48000 * Length_S));
+    float Lp = 0.0f;
+    for (size_t i = 0; i < IR.size(); i++)
+    {
+        Lp += .3f * ((R.Uniform() * 2.0f - 1.0f) - Lp);
+        IR[i] = Lp * expf(-float(i) / (48000.0f * Length_S * .2f));
+    }
+    return MakoIR_Build(Key, IR.data(), int(IR.size()), 48000.0, Rate);
+}
+
+//R1.01 The HOST. Worker 0 is the calling thread, like a host's audio thread, the others are helpers.
+//R1.01 Each period: release the workers, everyone takes instances from Next until all are done.
+struct tp_host {
+    std::vector<tp_instance>* Inst = nullptr;
+    const std::vector<float>* Src = nullptr;
+    int Block = 0;
+    int Threads = 1;
+
+    std::atomic<int> Gen{ 0 };
+    std::atomic<int> Next{ 0 };
+    std::atomic<int> Done{ 0 };
+    std::atomic<bool> Quit{ false };
+    int Cycle = 0;
+
+    std::vector<std::vector<float>> Times;     //R1.01 Process times per worker, uS.
+
+    void Run_Share(int Worker)
+    {
+        auto& Mine = Times[size_t(Worker)];
+        auto& I = *Inst;
+        const size_t Len = Src->size() - size_t(Block);
+        for (;;)
+        {
+            int n = Next.fetch_add(1, std::memory_order_relaxed);
+            if (n >= int(I.size())) break;
+
+            //R1.01 The host copies the input in, we process in place.
+            tp_instance& In = I[size_t(n)];
+            size_t Pos = (size_t(In.Offset) + size_t(Cycle) * size_t(Block)) % Len;
+            memcpy(In.Data[0], Src->data() + Pos, sizeof(float) * size_t(Block));
+            if (In.Mono)
+                memcpy(In.Data[1], In.Data[0], sizeof(float) * size_t(Block));
+            else
+                memcpy(In.Data[1], Src->data() + (Pos + 977) % Len, sizeof(float) * size_t(Block));
+
+            auto t0 = std::chrono::steady_clock::now();
+            In.Engine->Process(In.Data, Block);
+            auto t1 = std::chrono::steady_clock::now();
+            Mine.push_back(float(std::chrono::duration<double, std::micro>(t1 - t0).count()));
+            Done.fetch_add(1, std::memory_order_release);
+        }
+    }
+
+    void Run_Helper(int Worker)
+    {
+        Bench_Audio = true;
+        int Seen = 0;
+        for (;;)
+        {
+            int g;
+            while ((g = Gen.load(std::memory_order_acquire)) == Seen)
+            {
+                if (Quit.load(std::memory_order_relaxed)) return;
+                std::this_thread::yield();
+            }
+            Seen = g;
+            Run_Share(Worker);
+        }
+    }
+};
+
+struct tp_result {
+    int Threads;
+    int Cycles;
+    int Misses;
+    double Seconds;
+    std::vector<double> Period;    //R1.01 Block period times, mS.
+    std::vector<float> Block;      //R1.01 Process times, uS.
+};
+
+static double Bench_Pct(const std::vector<double>& v, double p) { return v.empty() ? 0.0 : v[std::min(v.size() - 1, size_t(p * double(v.size())))]; }
+static double Bench_Pct(const std::vector<float>& v, double p) { return v.empty() ? 0.0 : double(v[std::min(v.size() - 1, size_t(p * double(v.size())))]); }
+
+static tp_result Bench_Run(std::vector<tp_instance>& Inst, const std::vector<float>& Src, int Block, double Rate, double Seconds, int Threads)
+{
+    tp_host Host;
+    Host.Inst = &Inst;
+    Host.Src = &Src;
+    Host.Block = Block;
+    Host.Threads = Threads;
+
+    int Cycles = std::max(1, int(Seconds * Rate / Block));
+    double Deadline_mS = 1000.0 * Block / Rate;
+    Host.Times.resize(size_t(Threads));
+    for (auto& T : Host.Times) T.reserve(size_t(Cycles) * Inst.size());
+
+    tp_result Res;
+    Res.Threads = Threads;
+    Res.Cycles = Cycles;
+    Res.Misses = 0;
+    Res.Period.reserve(size_t(Cycles));
+
+    std::vector<std::thread> Helpers;
+    for (int w = 1; w < Threads; w++) Helpers.emplace_back([&Host, w] { Host.Run_Helper(w); });
+
+    Bench_Audio = true;
+    auto Start = std::chrono::steady_clock::now();
+    for (int c = 0; c < Cycles; c++)
+    {
+        auto t0 = std::chrono::steady_clock::now();
+        Host.Cycle = c;
+        Host.Next.store(0, std::memory_order_relaxed);
+        Host.Done.store(0, std::memory_order_relaxed);
+        Host.Gen.fetch_add(1, std::memory_order_release);
+
+        Host.Run_Share(0);
+        while (Host.Done.load(std::memory_order_acquire) < int(Inst.size())) std::this_thread::yield();
+
+        double mS = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        Res.Period.push_back(mS);
+        if (Deadline_mS < mS) Res.Misses++;
+    }
+    Res.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+    Bench_Audio = false;
+
+    Host.Quit.store(true);
+    for (auto& H : Helpers) H.join();
+
+    for (auto& T : Host.Times) Res.Block.insert(Res.Block.end(), T.begin(), T.end());
+    std::sort(Res.Period.begin(), Res.Period.end());
+    std::sort(Res.Block.begin(), Res.Block.end());
+    return Res;
+}
+
+int main(int argc, char** argv)
+{
+    int Count = 100;
+    int Threads = std::max(1, int(std::thread::hardware_concurrency()));
+    int Block = 128;
+    double Rate = 48000.0;
+    double Seconds = 5.0;
+    uint32_t Seed = 1;
+    bool Scale = false;
+
+    for (int a = 1; a < argc; a++)
+    {
+        std::string Arg = argv[a];
+        bool More = (a + 1 < argc);
+        if ((Arg == "-n") && More) Count = std::max(1, atoi(argv[++a]));
+        else if ((Arg == "-t") && More) Threads = std::max(1, atoi(argv[++a]));
+        else if ((Arg == "-b") && More) Block = std::min(std::max(1, atoi(argv[++a])), 8192);
+        else if ((Arg == "-r") && More) Rate = std::max(8000.0, atof(argv[++a]));
+        else if ((Arg == "-s") && More) Seconds = std::max(.1, atof(argv[++a]));
+        else if ((Arg == "-seed") && More) Seed = uint32_t(atoi(argv[++a]));
+        else if (Arg == "-scale") Scale = true;
+        else
+        {
+            printf("MakoSessionBench [-n instances] [-t threads] [-b block] [-r rate] [-s seconds] [-seed n] [-scale]\n");
+            return 1;
+        }
+    }
+
+    //R1.01 Shared things first, so the per instance heap is only what each instance owns.
+    auto Src = Bench_Source(Rate, 8);
+    int64_t Heap_Start = Heap_Live.load();
+    std::shared_ptr<const MakoIR> IRs[2] = { Bench_IR("bench:cab_short", Rate, .05f, 11), Bench_IR("bench:cab_room", Rate, .5f, 23) };
+    int64_t Heap_IR = Heap_Live.load() - Heap_Start;
+
+    //R1.01 The SESSION.
+    int64_t Heap_Before = Heap_Live.load();
+    tp_random R{ Seed };
+    std::vector<tp_instance> Inst;
+    Inst.resize(size_t(Count));
+    int Dual = 0, Cab = 0, MonoIn = 0;
+    for (auto& In : Inst)
+    {
+        In.Engine = std::make_unique<MakoEngine>();
+        auto P = Bench_Params(R);
+        In.Engine->SetParams(P);
+        In.Engine->Prepare(Rate, Block);
+        if (R.Chance(.5f))
+        {
+            In.Engine->Mako_IR_Set(IRs[R.Pick(2)]);
+            Cab++;
+        }
+        In.Mono = R.Chance(.25f);
+        In.Offset = R.Pick(int(Src.size()) - Block);
+        for (auto& B : In.Buffer) B.assign(size_t(Block), 0.0f);
+        In.Data[0] = In.Buffer[0].data();
+        In.Data[1] = In.Buffer[1].data();
+        Dual += P.Dual ? 1 : 0;
+        MonoIn += In.Mono ? 1 : 0;
+    }
+
+    //R1.01 Let the coefficient thread finish, then one warm up pass picks everything up.
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    Bench_Run(Inst, Src, Block, Rate, .1, 1);
+    int64_t Heap_Session = Heap_Live.load() - Heap_Before;
+    Heap_Audio.store(0);
+
+    printf("MakoSessionBench: %d instances, block %d at %.0f Hz (deadline %.3f mS), %.1f s of audio per run, kernels %s\n",
+           Count, Block, Rate, 1000.0 * Block / Rate, Seconds, Inst[0].Engine->Mako_Kernels_Name());
+    printf("Session: %d dual mono, %d with a cab IR, %d with a mono input, seed %u\n", Dual, Cab, MonoIn, Seed);
+    printf("Memory: %.1f KB heap per instance (sizeof MakoEngine %.1f KB), shared cab IRs %.1f KB.\n"
+           "        Thread stacks not counted, all instances share one coefficient thread and the convolver workers.\n",
+           double(Heap_Session) / Count / 1024.0, double(sizeof(MakoEngine)) / 1024.0, double(Heap_IR) / 1024.0);
+
+    std::vector<int> Counts;
+    if (Scale)
+        for (int t = 1; t < Threads; t *= 2) Counts.push_back(t);
+    Counts.push_back(Threads);
+
+    printf("\nthreads  misses          period mS: p50     p99    p999     max   instance uS: p50     p99    p999     max   inst/s     speedup  eff\n");
+    double Base = 0.0;
+    for (int t : Counts)
+    {
+        auto Res = Bench_Run(Inst, Src, Block, Rate, Seconds, t);
+        double Rate_Inst = double(Res.Cycles) * Count / Res.Seconds;
+        if (Base <= 0.0) Base = Rate_Inst / t;
+        printf("%7d  %6d %6.2f%%   %8.3f %7.3f %7.3f %7.3f   %12.1f %7.1f %7.1f %7.1f   %9.0f  %7.2fx %4.0f%%\n",
+               t, Res.Misses, 100.0 * Res.Misses / Res.Cycles,
+               Bench_Pct(Res.Period, .5), Bench_Pct(Res.Period, .99), Bench_Pct(Res.Period, .999), Res.Period.back(),
+               Bench_Pct(Res.Block, .5), Bench_Pct(Res.Block, .99), Bench_Pct(Res.Block, .999), double(Res.Block.back()),
+               Rate_Inst, Rate_Inst / Base, 100.0 * Rate_Inst / (Base * t));
+    }
+
+    int64_t Audio_Allocs = Heap_Audio.load();
+    printf("\nHeap allocations on the worker threads: %lld%s\n", (long long)Audio_Allocs, (Audio_Allocs == 0) ? "" : "  <-- Process must never allocate");
+    return (Audio_Allocs == 0) ? 0 : 2;
+}